@@ -0,0 +1,38 @@
+#include <VL53L1XMonitorArray.h>
+#include <Wire.h>
+
+// XSHUT pins of the four sensors sharing the I²C bus
+const uint8_t xshutPins[] = {16, 17, 18, 19};
+
+// Create an array of VL53L1X monitors with a 50 ms update interval
+VL53L1XMonitorArray sensors(xshutPins, 4, &Wire, 50);
+
+// Callback for an object entering the zone of any sensor
+void laneEnterCallback(uint16_t distance) {
+    Serial.print("Lane: Object detected at ");
+    Serial.print(distance);
+    Serial.println(" mm");
+}
+
+void setup() {
+    Serial.begin(115200);
+
+    // Initialize the custom I²C bus with specific pins
+    Wire.begin(21, 22); // Example: SDA = 21, SCL = 22 for ESP32
+
+    // Boot the sensors one by one and assign them addresses 0x2A to 0x2D
+    if (!sensors.init()) {
+        Serial.println("Sensor initialization failed!");
+        while (1);
+    }
+
+    // Add the same zone to every sensor
+    for (size_t i = 0; i < sensors.getSensorCount(); i++) {
+        sensors.addZone(i, 100, 300, laneEnterCallback);
+    }
+}
+
+void loop() {
+    // Read whichever sensor has a new measurement, one per call
+    sensors.update();
+}
@@ -0,0 +1,198 @@
+// VL53L1X Monitor Library - Host benchmark
+// GPL License
+//
+// Replays a distance trace through ZoneObserver::evaluate() and through the
+// monitors, and reports samples per second and heap allocations for 1, 10,
+// 100 and 1000 zones. It builds on a PC with the stand-in headers in host/;
+// no sensor or board is needed. From the repository root:
+//
+//   g++ -std=c++11 -O2 -Iextras/benchmark/host -Isrc extras/benchmark/ZoneBenchmark.cpp src/VL53L1XZoneMonitor.cpp -o zone_benchmark
+//   ./zone_benchmark [trace.txt] [samples]
+//
+// trace.txt holds one distance in millimeters per line, for example logged
+// with Serial.println(monitor.getDistance()); other lines are skipped. A
+// synthetic trace is used if no file is given. samples is the number of
+// measurements replayed per configuration (default 200000).
+
+#include "VL53L1XZoneMonitor.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+static size_t allocation_count = 0;
+
+void *operator new(size_t size)
+{
+    allocation_count++;
+    void *p = std::malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    std::free(p);
+}
+
+static const uint16_t RANGE_MM = 4000;
+static const uint32_t PERIOD_MS = 50;
+static const size_t CERTAINTY = 2;
+
+static size_t transitions = 0;
+
+static void countEnter(void *, uint16_t)
+{
+    transitions++;
+}
+
+static void countExit(void *)
+{
+    transitions++;
+}
+
+static std::vector<uint16_t> loadTrace(const char *path)
+{
+    std::vector<uint16_t> trace;
+    FILE *file = std::fopen(path, "r");
+    if (!file)
+    {
+        std::fprintf(stderr, "cannot open %s\n", path);
+        std::exit(1);
+    }
+    char line[64];
+    while (std::fgets(line, sizeof(line), file))
+    {
+        char *end;
+        long distance = std::strtol(line, &end, 10);
+        if (end != line && distance >= 0 && distance <= UINT16_MAX)
+            trace.push_back((uint16_t)distance);
+    }
+    std::fclose(file);
+    return trace;
+}
+
+// An empty scene at the far wall with a person walking in and out now and then.
+static std::vector<uint16_t> syntheticTrace(size_t length)
+{
+    std::vector<uint16_t> trace;
+    uint32_t seed = 12345;
+    int position = RANGE_MM - 500;
+    int target = position;
+    for (size_t i = 0; i < length; i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        if (position == target)
+            target = (seed >> 16) % 4 == 0 ? 300 + (seed >> 8) % (RANGE_MM - 800) : RANGE_MM - 500;
+        position += target > position ? std::min(40, target - position) : -std::min(40, position - target);
+        int noise = (int)((seed >> 20) % 21) - 10;
+        trace.push_back((uint16_t)(position + noise));
+    }
+    return trace;
+}
+
+// Zone i covers two steps starting at i steps, so neighbouring zones overlap
+// and every zone spans five segments of the interval index.
+static void zoneBounds(size_t i, size_t zone_count, uint16_t &min, uint16_t &max)
+{
+    uint16_t step = RANGE_MM / zone_count ? RANGE_MM / zone_count : 1;
+    min = (uint16_t)(i * step);
+    max = (uint16_t)(min + 2 * step);
+}
+
+static void report(const char *name, size_t zone_count, size_t samples, double seconds, size_t setup_allocs, size_t run_allocs)
+{
+    std::printf("%-22s %5zu zones %12.0f samples/s  %6zu setup allocs  %3zu run allocs  %8zu transitions\n",
+                name, zone_count, samples / seconds, setup_allocs, run_allocs, transitions);
+}
+
+static void benchObservers(const std::vector<uint16_t> &trace, size_t zone_count, size_t samples)
+{
+    transitions = 0;
+    size_t before = allocation_count;
+    std::vector<ZoneObserver> zones;
+    zones.reserve(zone_count);
+    for (size_t i = 0; i < zone_count; i++)
+    {
+        uint16_t min, max;
+        zoneBounds(i, zone_count, min, max);
+        zones.push_back(ZoneObserver(min, max, ZoneEnterCallback(countEnter, nullptr), ZoneExitCallback(countExit, nullptr)));
+    }
+    size_t setup_allocs = allocation_count - before;
+
+    before = allocation_count;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t s = 0; s < samples; s++)
+    {
+        uint16_t distance = trace[s % trace.size()];
+        for (size_t i = 0; i < zone_count; i++)
+            zones[i].evaluate(distance, CERTAINTY);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    report("ZoneObserver", zone_count, samples, elapsed.count(), setup_allocs, allocation_count - before);
+}
+
+static void benchMonitor(const char *name, VL53L1XZoneMonitorBase &monitor, const std::vector<uint16_t> &trace,
+                         size_t zone_count, size_t samples)
+{
+    transitions = 0;
+    size_t before = allocation_count;
+    VL53L1XReplaySource source(trace.data(), trace.size(), PERIOD_MS, true);
+    monitor.setSampleSource(&source);
+    for (size_t i = 0; i < zone_count; i++)
+    {
+        uint16_t min, max;
+        zoneBounds(i, zone_count, min, max);
+        monitor.addZone(min, max, countEnter, countExit, nullptr);
+    }
+    monitor.update(); // The first update builds the zone index.
+    size_t setup_allocs = allocation_count - before;
+
+    before = allocation_count;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t s = 1; s < samples; s++)
+        monitor.update();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    report(name, zone_count, samples, elapsed.count(), setup_allocs, allocation_count - before);
+    monitor.setSampleSource(nullptr);
+}
+
+// The default index capacity of four entries per zone is too small for this
+// layout and would measure the linear fallback instead of the index.
+typedef VL53L1XZoneMonitorT<1000, 5 * 1000> FixedMonitor;
+
+static FixedMonitor fixed_monitor_storage[4];
+
+int main(int argc, char **argv)
+{
+    std::vector<uint16_t> trace = argc > 1 ? loadTrace(argv[1]) : syntheticTrace(10000);
+    size_t samples = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200000;
+    if (trace.empty() || samples == 0)
+    {
+        std::fprintf(stderr, "empty trace\n");
+        return 1;
+    }
+    std::printf("%zu samples per run, trace of %zu distances\n", samples, trace.size());
+
+    static const size_t zone_counts[] = {1, 10, 100, 1000};
+    for (size_t c = 0; c < sizeof(zone_counts) / sizeof(zone_counts[0]); c++)
+    {
+        size_t zone_count = zone_counts[c];
+        benchObservers(trace, zone_count, samples);
+
+        VL53L1XZoneMonitor monitor(nullptr, PERIOD_MS, CERTAINTY);
+        benchMonitor("VL53L1XZoneMonitor", monitor, trace, zone_count, samples);
+
+        FixedMonitor &fixed_monitor = fixed_monitor_storage[c];
+        fixed_monitor.setCertaintyFactor(CERTAINTY);
+        benchMonitor("VL53L1XZoneMonitorT", fixed_monitor, trace, zone_count, samples);
+    }
+    return 0;
+}
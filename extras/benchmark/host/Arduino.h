@@ -0,0 +1,51 @@
+// Host stand-in for the parts of the Arduino core used by the library.
+// Only for building extras/benchmark on a PC; never used on a board.
+
+#ifndef ARDUINO_HOST_H
+#define ARDUINO_HOST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <chrono>
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+#define FALLING 2
+#define NOT_AN_INTERRUPT -1
+
+inline uint32_t micros()
+{
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline uint32_t millis()
+{
+    return micros() / 1000;
+}
+
+inline void delay(uint32_t) {}
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return HIGH; }
+inline int digitalPinToInterrupt(uint8_t) { return NOT_AN_INTERRUPT; }
+inline void attachInterrupt(int, void (*)(void), int) {}
+inline void detachInterrupt(int) {}
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        size_t n = 0;
+        while (size--)
+            n += write(*buffer++);
+        return n;
+    }
+};
+
+#endif // ARDUINO_HOST_H
@@ -0,0 +1,80 @@
+// Host stand-in for the Pololu VL53L1X driver. It declares the subset of the
+// driver API used by the library and never produces measurements; the
+// benchmark feeds the monitor through a VL53L1XSampleSource instead.
+
+#ifndef VL53L1X_HOST_H
+#define VL53L1X_HOST_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+class VL53L1X {
+public:
+    enum regAddr : uint16_t {
+        DSS_CONFIG__MANUAL_EFFECTIVE_SPADS_SELECT = 0x0054,
+        SYSTEM__INTERRUPT_CLEAR = 0x0086,
+        RESULT__RANGE_STATUS = 0x0089,
+        RESULT__DSS_ACTUAL_EFFECTIVE_SPADS_SD0 = 0x008C,
+        RESULT__AMBIENT_COUNT_RATE_MCPS_SD0 = 0x0090,
+        RESULT__FINAL_CROSSTALK_CORRECTED_RANGE_MM_SD0 = 0x0096,
+        IDENTIFICATION__MODEL_ID = 0x010F
+    };
+
+    enum DistanceMode { Short, Medium, Long, Unknown };
+
+    enum RangeStatus : uint8_t {
+        RangeValid = 0,
+        SigmaFail = 1,
+        SignalFail = 2,
+        RangeValidMinRangeClipped = 3,
+        OutOfBoundsFail = 4,
+        HardwareFail = 5,
+        RangeValidNoWrapCheckFail = 6,
+        WrapTargetFail = 7,
+        XtalkSignalFail = 9,
+        SynchronizationInt = 10,
+        MinRangeFail = 13,
+        None = 255
+    };
+
+    struct RangingData {
+        uint16_t range_mm;
+        RangeStatus range_status;
+        float peak_signal_count_rate_MCPS;
+        float ambient_count_rate_MCPS;
+    };
+
+    RangingData ranging_data = {0, None, 0, 0};
+    uint8_t last_status = 0;
+
+    void setBus(TwoWire *) {}
+    void writeReg(uint16_t, uint8_t) {}
+    void writeReg16Bit(uint16_t, uint16_t) {}
+    uint16_t readReg16Bit(uint16_t) { return 0; }
+    uint32_t readReg32Bit(uint16_t) { return 0; }
+    bool init(bool = true) { return true; }
+    void setAddress(uint8_t new_addr) { address = new_addr; }
+    uint8_t getAddress() { return address; }
+    bool setDistanceMode(DistanceMode mode) { distance_mode = mode; return true; }
+    DistanceMode getDistanceMode() { return distance_mode; }
+    bool setMeasurementTimingBudget(uint32_t budget_us) { timing_budget = budget_us; return true; }
+    uint32_t getMeasurementTimingBudget() { return timing_budget; }
+    void setTimeout(uint16_t timeout) { io_timeout = timeout; }
+    uint16_t getTimeout() { return io_timeout; }
+    void setROISize(uint8_t, uint8_t) {}
+    void setROICenter(uint8_t) {}
+    void startContinuous(uint32_t) {}
+    void stopContinuous() {}
+    bool dataReady() { return false; }
+    uint16_t read(bool = true) { return 0; }
+    uint16_t readSingle(bool = true) { return 0; }
+    bool timeoutOccurred() { return false; }
+
+private:
+    uint8_t address = 0x29;
+    DistanceMode distance_mode = Long;
+    uint32_t timing_budget = 50000;
+    uint16_t io_timeout = 0;
+};
+
+#endif // VL53L1X_HOST_H
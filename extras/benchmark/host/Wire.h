@@ -0,0 +1,12 @@
+// Host stand-in for the Arduino Wire library. The benchmark never touches
+// the bus; the type only has to exist.
+
+#ifndef WIRE_HOST_H
+#define WIRE_HOST_H
+
+#include <Arduino.h>
+
+class TwoWire {
+};
+
+#endif // WIRE_HOST_H
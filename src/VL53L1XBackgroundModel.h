@@ -0,0 +1,145 @@
+#ifndef VL53L1XBACKGROUNDMODEL_H
+#define VL53L1XBACKGROUNDMODEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Running baseline of the static scene, used to suppress fixed reflectors.
+ *
+ * The first distance after a reset becomes the baseline. Later distances
+ * within the tolerance of it match the background and pull the baseline
+ * towards them by 1/2^shift, so slow drift from temperature or ambient light
+ * is followed. A distance that differs is foreground. If the foreground
+ * stays at one distance, within the tolerance, for the absorb time, it
+ * becomes the new baseline, e.g. a box put down in front of a shelf. Costs
+ * a few integer operations per measurement and fixed storage only.
+ */
+class VL53L1XBackgroundModel {
+public:
+    static const uint8_t MAX_ADAPT_SHIFT = 8; /**< Largest supported adaptation weight exponent. */
+
+private:
+    uint32_t accumulator;    /**< Baseline scaled by 2^shift. */
+    uint32_t change_time;    /**< Timestamp of the first measurement at the candidate distance. */
+    uint32_t absorb_ms;      /**< Time a steady foreground takes to become background; 0 never. */
+    uint16_t tolerance;      /**< Largest difference from the baseline that matches it, in millimeters. */
+    uint16_t candidate;      /**< Distance of the current foreground in millimeters. */
+    uint8_t shift;           /**< Adaptation weight exponent. */
+    bool learned;            /**< False until the first measurement after a reset. */
+    bool changing;           /**< Set while the foreground holds a candidate distance. */
+
+public:
+    /**
+     * @brief Constructs a model with a 50 mm tolerance, a 1/64 adaptation weight and no absorption.
+     */
+    VL53L1XBackgroundModel()
+        : accumulator(0), change_time(0), absorb_ms(0), tolerance(50), candidate(0), shift(6), learned(false), changing(false) {}
+
+    /**
+     * @brief Sets the model parameters and forgets the baseline.
+     *
+     * @param tolerance_mm Largest difference from the baseline that still matches it, in millimeters.
+     * @param absorb Time in milliseconds a steady foreground takes to become background; 0 never.
+     * @param adapt_shift Weight exponent k from 1 to MAX_ADAPT_SHIFT; each matching distance weighs 1/2^k.
+     * @return True on success, false if a parameter is out of range.
+     */
+    bool configure(uint16_t tolerance_mm, uint32_t absorb, uint8_t adapt_shift)
+    {
+        if (tolerance_mm == 0 || adapt_shift < 1 || adapt_shift > MAX_ADAPT_SHIFT)
+            return false;
+        tolerance = tolerance_mm;
+        absorb_ms = absorb;
+        shift = adapt_shift;
+        reset();
+        return true;
+    }
+
+    /**
+     * @brief Forgets the baseline; the next distance is learned as the new one.
+     */
+    void reset()
+    {
+        learned = false;
+        changing = false;
+    }
+
+    /**
+     * @brief Adds a distance and classifies it.
+     *
+     * @param distance Measured distance in millimeters.
+     * @param timestamp Time of the measurement in milliseconds.
+     * @return True if the distance matches the background.
+     */
+    bool update(uint16_t distance, uint32_t timestamp)
+    {
+        if (!learned)
+        {
+            seed(distance);
+            return true;
+        }
+        if (difference(distance, getBaseline()) <= tolerance)
+        {
+            accumulator -= accumulator >> shift;
+            accumulator += distance;
+            changing = false;
+            return true;
+        }
+        if (absorb_ms == 0)
+            return false;
+        if (!changing || difference(distance, candidate) > tolerance)
+        {
+            candidate = distance;
+            change_time = timestamp;
+            changing = true;
+            return false;
+        }
+        if (timestamp - change_time < absorb_ms)
+            return false;
+        seed(distance);
+        return true;
+    }
+
+    /**
+     * @brief Checks whether a baseline has been learned.
+     *
+     * @return True once a distance has been added since the last reset.
+     */
+    bool isLearned() const
+    {
+        return learned;
+    }
+
+    /**
+     * @brief Gets the baseline.
+     *
+     * @return The background distance in millimeters, or 0 if none has been learned.
+     */
+    uint16_t getBaseline() const
+    {
+        return learned ? (uint16_t)(accumulator >> shift) : 0;
+    }
+
+private:
+    /**
+     * @brief Gets the absolute difference of two distances.
+     */
+    static uint16_t difference(uint16_t a, uint16_t b)
+    {
+        return a > b ? a - b : b - a;
+    }
+
+    /**
+     * @brief Makes a distance the baseline.
+     *
+     * @param distance Distance in millimeters.
+     */
+    void seed(uint16_t distance)
+    {
+        accumulator = (uint32_t)distance << shift;
+        learned = true;
+        changing = false;
+    }
+};
+
+#endif // VL53L1XBACKGROUNDMODEL_H
@@ -0,0 +1,69 @@
+#ifndef VL53L1XBUSLOCK_H
+#define VL53L1XBUSLOCK_H
+
+#include <stdint.h>
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#endif
+
+/**
+ * @brief Arbitrates an I²C bus shared with other drivers.
+ *
+ * A monitor with a bus lock attached acquires it around every access to the
+ * sensor and releases it before zone evaluation and callbacks, so callbacks
+ * may use the bus themselves. Implement it with the mutex the other drivers
+ * use, or with a slot of a cooperative scheduler.
+ */
+class VL53L1XBusLock {
+public:
+    static const uint32_t WAIT_FOREVER = UINT32_MAX; /**< Timeout waiting until the bus is free. */
+
+    virtual ~VL53L1XBusLock() {}
+
+    /**
+     * @brief Takes the bus.
+     *
+     * @param timeout_ms Longest time to wait in milliseconds, 0 to only try,
+     *        or WAIT_FOREVER.
+     * @return True if the bus was taken, false if it stayed busy.
+     */
+    virtual bool acquire(uint32_t timeout_ms) = 0;
+
+    /**
+     * @brief Gives the bus back after a successful acquire().
+     */
+    virtual void release() = 0;
+};
+
+#if defined(ESP32)
+/**
+ * @brief Bus lock on a FreeRTOS mutex shared with the other drivers on the bus.
+ */
+class VL53L1XSemaphoreBusLock : public VL53L1XBusLock {
+private:
+    SemaphoreHandle_t mutex; /**< Mutex guarding the bus. */
+
+public:
+    /**
+     * @brief Constructs a bus lock on an existing mutex.
+     *
+     * @param bus_mutex Mutex created with xSemaphoreCreateMutex(); must outlive the lock.
+     */
+    explicit VL53L1XSemaphoreBusLock(SemaphoreHandle_t bus_mutex) : mutex(bus_mutex) {}
+
+    bool acquire(uint32_t timeout_ms) override
+    {
+        TickType_t ticks = timeout_ms == WAIT_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+        return xSemaphoreTake(mutex, ticks) == pdTRUE;
+    }
+
+    void release() override
+    {
+        xSemaphoreGive(mutex);
+    }
+};
+#endif
+
+#endif // VL53L1XBUSLOCK_H
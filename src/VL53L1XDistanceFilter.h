@@ -0,0 +1,164 @@
+#ifndef VL53L1XDISTANCEFILTER_H
+#define VL53L1XDISTANCEFILTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Streaming prefilter smoothing distances before zone evaluation.
+ *
+ * Supports a windowed median of up to MAX_MEDIAN_TAPS measurements and an
+ * exponential moving average with a power-of-two weight. Both use integer
+ * arithmetic and fixed storage only, so they are cheap without an FPU. A median
+ * removes single outliers with a delay of half its window, which for most
+ * scenes replaces a high certainty factor.
+ */
+class VL53L1XDistanceFilter {
+public:
+    enum Mode : uint8_t {
+        None,   /**< Distances pass through unchanged. */
+        Median, /**< Median of the last taps distances. */
+        Ema     /**< Exponential moving average. */
+    };
+
+    static const uint8_t MAX_MEDIAN_TAPS = 7; /**< Largest supported median window. */
+    static const uint8_t MAX_EMA_SHIFT = 8;   /**< Largest supported EMA weight exponent. */
+
+private:
+    uint16_t window[MAX_MEDIAN_TAPS]; /**< Median window in arrival order, used as a ring. */
+    uint16_t sorted[MAX_MEDIAN_TAPS]; /**< The same distances in ascending order. */
+    uint32_t ema_accumulator;         /**< EMA value scaled by 2^parameter. */
+    Mode mode;                        /**< Active filter. */
+    uint8_t parameter;                /**< Number of median taps, or the EMA weight exponent. */
+    uint8_t count;                    /**< Distances seen since the last reset, saturating at the window size. */
+    uint8_t head;                     /**< Slot of the oldest distance in window. */
+
+public:
+    /**
+     * @brief Constructs a filter that passes distances through unchanged.
+     */
+    VL53L1XDistanceFilter() : ema_accumulator(0), mode(None), parameter(0), count(0), head(0) {}
+
+    /**
+     * @brief Selects the filter.
+     *
+     * @param filter_mode The filter to use.
+     * @param param For Median the odd window size from 3 to MAX_MEDIAN_TAPS;
+     *        for Ema the weight exponent k from 1 to MAX_EMA_SHIFT, so each
+     *        distance weighs 1/2^k. Ignored for None.
+     * @return True on success, false if the parameter is out of range.
+     */
+    bool configure(Mode filter_mode, uint8_t param)
+    {
+        if (filter_mode == Median && (param < 3 || param > MAX_MEDIAN_TAPS || param % 2 == 0))
+            return false;
+        if (filter_mode == Ema && (param < 1 || param > MAX_EMA_SHIFT))
+            return false;
+        mode = filter_mode;
+        parameter = filter_mode == None ? 0 : param;
+        reset();
+        return true;
+    }
+
+    /**
+     * @brief Gets the selected filter.
+     *
+     * @return The filter mode.
+     */
+    Mode getMode() const
+    {
+        return mode;
+    }
+
+    /**
+     * @brief Gets the filter parameter.
+     *
+     * @return The median window size or EMA weight exponent; 0 for None.
+     */
+    uint8_t getParameter() const
+    {
+        return parameter;
+    }
+
+    /**
+     * @brief Forgets all previous distances.
+     */
+    void reset()
+    {
+        count = 0;
+        head = 0;
+        ema_accumulator = 0;
+    }
+
+    /**
+     * @brief Adds a distance and returns the filtered value.
+     *
+     * Until the median window has filled, the median of the distances seen
+     * so far is returned. The EMA starts at the first distance.
+     *
+     * @param distance Measured distance in millimeters.
+     * @return Filtered distance in millimeters.
+     */
+    uint16_t apply(uint16_t distance)
+    {
+        if (mode == Median)
+            return applyMedian(distance);
+        if (mode == Ema)
+        {
+            if (count == 0)
+            {
+                ema_accumulator = (uint32_t)distance << parameter;
+                count = 1;
+            }
+            else
+            {
+                ema_accumulator -= ema_accumulator >> parameter;
+                ema_accumulator += distance;
+            }
+            return (uint16_t)(ema_accumulator >> parameter);
+        }
+        return distance;
+    }
+
+private:
+    /**
+     * @brief Replaces the oldest distance in the window and keeps it sorted.
+     *
+     * Costs at most one pass over the window, independent of the history.
+     *
+     * @param distance Measured distance in millimeters.
+     * @return The median of the window.
+     */
+    uint16_t applyMedian(uint16_t distance)
+    {
+        uint8_t used = count;
+        if (count == parameter)
+        {
+            // Remove the oldest distance from the sorted copy.
+            uint16_t oldest = window[head];
+            uint8_t i = 0;
+            while (sorted[i] != oldest)
+                i++;
+            for (; i + 1 < used; i++)
+                sorted[i] = sorted[i + 1];
+            used--;
+        }
+        else
+        {
+            count++;
+        }
+        window[head] = distance;
+        head = head + 1 == parameter ? 0 : head + 1;
+
+        uint8_t i = used;
+        while (i > 0 && sorted[i - 1] > distance)
+        {
+            sorted[i] = sorted[i - 1];
+            i--;
+        }
+        sorted[i] = distance;
+        return sorted[used / 2];
+    }
+};
+
+#endif // VL53L1XDISTANCEFILTER_H
@@ -0,0 +1,100 @@
+// VL53L1X Monitor Library - Implementation File
+// GPL License
+// This file contains the implementation of the VL53L1XMonitorArray class.
+
+#include "VL53L1XMonitorArray.h"
+
+VL53L1XMonitorArray::VL53L1XMonitorArray(const uint8_t *pins, size_t count, TwoWire *wire, uint32_t interval_ms,
+                                         size_t certainty, uint8_t address)
+    : xshut_pins(pins, pins + count), update_interval_ms(interval_ms), base_address(address), next_sensor(0)
+{
+    monitors.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        monitors.emplace_back(new VL53L1XZoneMonitor(wire, interval_ms, certainty));
+    }
+}
+
+bool VL53L1XMonitorArray::init(const uint8_t *interrupt_pins)
+{
+    for (uint8_t pin : xshut_pins)
+    {
+        pinMode(pin, OUTPUT);
+        digitalWrite(pin, LOW);
+    }
+
+    for (size_t i = 0; i < monitors.size(); i++)
+    {
+        // XSHUT is not level shifted on most carrier boards, so it is released
+        // to the on-board pull-up instead of being driven high.
+        pinMode(xshut_pins[i], INPUT);
+        delay(10);
+
+        uint8_t interrupt_pin = interrupt_pins ? interrupt_pins[i] : VL53L1XZoneMonitor::NO_INTERRUPT_PIN;
+        if (!monitors[i]->init(interrupt_pin))
+            return false;
+        monitors[i]->setAddress(base_address + i);
+    }
+
+    // Each sensor started ranging as soon as it booted. Restart them with
+    // evenly spaced offsets so their measurements do not complete together.
+    for (auto &monitor : monitors)
+    {
+        monitor->stopRanging();
+    }
+    uint32_t stagger_ms = monitors.empty() ? 0 : update_interval_ms / monitors.size();
+    for (size_t i = 0; i < monitors.size(); i++)
+    {
+        if (i > 0)
+            delay(stagger_ms);
+        monitors[i]->startRanging();
+    }
+    next_sensor = 0;
+    return true;
+}
+
+size_t VL53L1XMonitorArray::getSensorCount() const
+{
+    return monitors.size();
+}
+
+VL53L1XZoneMonitor *VL53L1XMonitorArray::getMonitor(size_t sensor_index)
+{
+    if (sensor_index < monitors.size())
+    {
+        return monitors[sensor_index].get();
+    }
+    return nullptr;
+}
+
+size_t VL53L1XMonitorArray::addZone(size_t sensor_index, uint16_t min, uint16_t max,
+                                    ZoneEnterCallback onEnter, ZoneExitCallback onExit)
+{
+    if (sensor_index >= monitors.size())
+        return VL53L1XZoneMonitorBase::INVALID_ZONE;
+    return monitors[sensor_index]->addZone(min, max, onEnter, onExit);
+}
+
+#if VL53L1XZONEMONITOR_ENABLE_FAULT_RECOVERY
+bool VL53L1XMonitorArray::enableFaultRecovery(uint8_t faults, uint32_t backoff_ms)
+{
+    for (size_t i = 0; i < monitors.size(); i++)
+    {
+        if (!monitors[i]->enableFaultRecovery(xshut_pins[i], faults, backoff_ms))
+            return false;
+    }
+    return true;
+}
+#endif
+
+bool VL53L1XMonitorArray::update()
+{
+    for (size_t checked = 0; checked < monitors.size(); checked++)
+    {
+        size_t index = next_sensor;
+        next_sensor = (next_sensor + 1) % monitors.size();
+        if (monitors[index]->update())
+            return true;
+    }
+    return false;
+}
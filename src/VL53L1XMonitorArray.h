@@ -0,0 +1,104 @@
+#ifndef VL53L1XMONITORARRAY_H
+#define VL53L1XMONITORARRAY_H
+
+#include "VL53L1XZoneMonitor.h"
+#include <memory>
+
+/**
+ * @brief Manages several VL53L1X sensors sharing one I²C bus.
+ *
+ * All sensors power up at the same default address, so the array holds every
+ * sensor in reset through its XSHUT pin and releases them one at a time,
+ * assigning each a unique address. Ranging is then restarted with evenly
+ * staggered start times so that measurements complete spread across the
+ * update interval, and update() services the sensors round-robin with at most
+ * one sensor read per call.
+ */
+class VL53L1XMonitorArray {
+private:
+    std::vector<uint8_t> xshut_pins;             /**< XSHUT pin of each sensor. */
+    std::vector<std::unique_ptr<VL53L1XZoneMonitor>> monitors; /**< One zone monitor per sensor. */
+    uint32_t update_interval_ms;                 /**< Interval for continuous measurements in milliseconds. */
+    uint8_t base_address;                        /**< I²C address assigned to the first sensor. */
+    size_t next_sensor;                          /**< Sensor serviced first on the next update() call. */
+
+public:
+    static const uint8_t DEFAULT_BASE_ADDRESS = 0x2A; /**< First address assigned; the power-up default is 0x29. */
+
+    /**
+     * @brief Constructs a VL53L1XMonitorArray object.
+     *
+     * @param xshut_pins MCU pins connected to each sensor's XSHUT input.
+     * @param count Number of sensors.
+     * @param wire Optional pointer to a TwoWire object for custom I²C bus.
+     * @param interval_ms Interval for continuous measurements in milliseconds.
+     * @param certainty Number of consecutive measurements required for stability.
+     * @param base_address I²C address for the first sensor; later sensors use the following addresses.
+     */
+    VL53L1XMonitorArray(const uint8_t *xshut_pins, size_t count, TwoWire *wire = nullptr, uint32_t interval_ms = 50,
+                        size_t certainty = 1, uint8_t base_address = DEFAULT_BASE_ADDRESS);
+
+    /**
+     * @brief Boots every sensor, assigns addresses and starts staggered ranging.
+     *
+     * @param interrupt_pins Optional array of GPIO1 pins, one per sensor. Use
+     *                       VL53L1XZoneMonitor::NO_INTERRUPT_PIN for sensors that are polled.
+     * @return True if every sensor was initialized, false otherwise.
+     */
+    bool init(const uint8_t *interrupt_pins = nullptr);
+
+    /**
+     * @brief Gets the number of sensors in the array.
+     *
+     * @return The number of sensors.
+     */
+    size_t getSensorCount() const;
+
+    /**
+     * @brief Gets the zone monitor of a specific sensor.
+     *
+     * @param sensor_index The index of the sensor, in the order of the XSHUT pins.
+     * @return Pointer to the monitor, or nullptr if the index is invalid.
+     */
+    VL53L1XZoneMonitor *getMonitor(size_t sensor_index);
+
+    /**
+     * @brief Adds a new monitoring zone to a specific sensor.
+     *
+     * @param sensor_index The index of the sensor.
+     * @param min Minimum distance for the zone in millimeters.
+     * @param max Maximum distance for the zone in millimeters.
+     * @param onEnter Callback function to execute when an object enters the zone.
+     * @param onExit Callback function to execute when an object exits the zone.
+     * @return The index of the new zone in the sensor's monitor, or INVALID_ZONE if the sensor index is invalid.
+     */
+    size_t addZone(size_t sensor_index, uint16_t min, uint16_t max, ZoneEnterCallback onEnter = nullptr,
+                   ZoneExitCallback onExit = nullptr);
+
+#if VL53L1XZONEMONITOR_ENABLE_FAULT_RECOVERY
+    /**
+     * @brief Enables fault recovery on every sensor, resetting each through its XSHUT pin.
+     *
+     * See VL53L1XZoneMonitorBase::enableFaultRecovery(). A recovering sensor
+     * boots at 0x29, which the array keeps free.
+     *
+     * @param faults Consecutive faulty reads that start a recovery, at least 1.
+     * @param backoff_ms Longest wait between recovery attempts in milliseconds.
+     * @return True on success, false if faults is 0.
+     */
+    bool enableFaultRecovery(uint8_t faults = 3, uint32_t backoff_ms = 10000);
+#endif
+
+    /**
+     * @brief Services the sensors round-robin.
+     *
+     * Sensors are checked starting after the one read last, and the first one
+     * with a new measurement is read and evaluated, so the bus carries at most
+     * one sensor read per call and no sensor is starved.
+     *
+     * @return True if a sensor was read, false otherwise.
+     */
+    bool update();
+};
+
+#endif
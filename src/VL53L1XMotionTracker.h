@@ -0,0 +1,181 @@
+#ifndef VL53L1XMOTIONTRACKER_H
+#define VL53L1XMOTIONTRACKER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Fixed-point alpha-beta filter estimating distance and radial velocity.
+ *
+ * Each measurement corrects the predicted position by alpha times the
+ * residual and the velocity by beta times the residual per elapsed time.
+ * The position is kept in 1/16 mm and the velocity in 1/4096 mm per
+ * millisecond, so one update costs a handful of 32-bit operations and one
+ * division without overflowing on 16-bit boards. A gap between
+ * measurements longer than the limit passed to update(), MAX_GAP_MS by
+ * default, restarts the estimate.
+ */
+class VL53L1XMotionTracker {
+public:
+    static const uint16_t MAX_GAP_MS = 1000; /**< Default longest gap between measurements that keeps the estimate. */
+
+private:
+    static const int32_t MAX_VELOCITY = (int32_t)16 << 12; /**< Velocity limit of 16 m/s, in 1/4096 mm/ms. */
+    static const int32_t MAX_POSITION = (int32_t)UINT16_MAX << 4; /**< Largest distance in 1/16 mm. */
+
+    int32_t position;     /**< Estimated distance in 1/16 mm. */
+    int32_t velocity;     /**< Estimated velocity in 1/4096 mm/ms; negative while approaching the sensor. */
+    uint32_t last_time;   /**< Timestamp of the last measurement in milliseconds. */
+    uint8_t alpha;        /**< Position gain in 1/256. */
+    uint8_t beta;         /**< Velocity gain in 1/256. */
+    bool tracking;        /**< False until the first measurement after a reset. */
+
+public:
+    /**
+     * @brief Constructs a tracker with the default gains.
+     */
+    VL53L1XMotionTracker() : position(0), velocity(0), last_time(0), alpha(128), beta(32), tracking(false) {}
+
+    /**
+     * @brief Sets the filter gains and restarts the estimate.
+     *
+     * Higher gains follow changes faster but pass more sensor noise into the
+     * velocity. The defaults of 128 and 32 suit walking speeds at 20 Hz.
+     *
+     * @param position_gain Alpha in 1/256, from 1 to 255.
+     * @param velocity_gain Beta in 1/256, from 1 to 255.
+     * @return True on success, false if a gain is 0.
+     */
+    bool configure(uint8_t position_gain, uint8_t velocity_gain)
+    {
+        if (position_gain == 0 || velocity_gain == 0)
+            return false;
+        alpha = position_gain;
+        beta = velocity_gain;
+        reset();
+        return true;
+    }
+
+    /**
+     * @brief Forgets the estimate; the next measurement starts a new one at rest.
+     */
+    void reset()
+    {
+        tracking = false;
+        velocity = 0;
+    }
+
+    /**
+     * @brief Adds a measurement.
+     *
+     * @param distance Measured distance in millimeters.
+     * @param timestamp Time of the measurement in milliseconds.
+     * @param max_gap Longest gap since the previous measurement in
+     *        milliseconds that keeps the estimate; pass a few sampling
+     *        periods, so that slow sampling does not restart it every time.
+     */
+    void update(uint16_t distance, uint32_t timestamp, uint32_t max_gap = MAX_GAP_MS)
+    {
+        int32_t measured = (int32_t)distance << 4;
+        uint32_t dt = timestamp - last_time;
+        last_time = timestamp;
+        if (!tracking || dt > max_gap)
+        {
+            position = measured;
+            velocity = 0;
+            tracking = true;
+            return;
+        }
+        if (dt == 0)
+            return;
+
+        // velocity * dt is in 1/4096 mm; dividing by 256 gives 1/16 mm.
+        // Widened, as the gaps of idle sampling overflow 32 bits at top speed.
+        int64_t predicted = position + ((int64_t)velocity * dt) / 256;
+        // Kept within the sensor's range, so the residual products below fit 32 bits.
+        if (predicted < 0)
+            predicted = 0;
+        else if (predicted > MAX_POSITION)
+            predicted = MAX_POSITION;
+        int32_t residual = measured - (int32_t)predicted;
+        position = (int32_t)predicted + (residual * alpha) / 256;
+        // residual / dt in 1/16 mm/ms, times beta in 1/256, is in 1/4096 mm/ms.
+        velocity += (residual * beta) / (int32_t)dt;
+        if (velocity > MAX_VELOCITY)
+            velocity = MAX_VELOCITY;
+        else if (velocity < -MAX_VELOCITY)
+            velocity = -MAX_VELOCITY;
+        if (position < 0)
+            position = 0;
+    }
+
+    /**
+     * @brief Checks whether an estimate is available.
+     *
+     * @return True once a measurement has been added since the last reset.
+     */
+    bool isTracking() const
+    {
+        return tracking;
+    }
+
+    /**
+     * @brief Gets the estimated distance.
+     *
+     * @return The filtered distance in millimeters.
+     */
+    uint16_t getPosition() const
+    {
+        int32_t mm = (position + 8) >> 4;
+        return mm > UINT16_MAX ? UINT16_MAX : (uint16_t)mm;
+    }
+
+    /**
+     * @brief Gets the estimated radial velocity.
+     *
+     * @return The velocity in millimeters per second; negative while the
+     *         object approaches the sensor.
+     */
+    int16_t getVelocity() const
+    {
+        return (int16_t)((velocity * 1000) / 4096);
+    }
+
+    /**
+     * @brief Predicts when the object reaches a distance range at its current velocity.
+     *
+     * @param min Start of the range in millimeters.
+     * @param max End of the range in millimeters.
+     * @param min_speed Speed in millimeters per second below which the object counts as not moving.
+     * @return The time in milliseconds, 0 if the estimate is inside the
+     *         range, or UINT32_MAX if the object is not moving towards it.
+     */
+    uint32_t timeToReach(uint16_t min, uint16_t max, uint16_t min_speed) const
+    {
+        if (!tracking)
+            return UINT32_MAX;
+        uint16_t distance = getPosition();
+        uint32_t gap;
+        int32_t speed;
+        if (distance > max)
+        {
+            gap = distance - max;
+            speed = -velocity;
+        }
+        else if (distance < min)
+        {
+            gap = min - distance;
+            speed = velocity;
+        }
+        else
+        {
+            return 0;
+        }
+        // Compare in 1/4096 mm/ms, where 1 mm/s is about 4.1 units.
+        if (speed <= 0 || speed * 1000 < (int32_t)min_speed * 4096)
+            return UINT32_MAX;
+        return (gap << 12) / (uint32_t)speed;
+    }
+};
+
+#endif // VL53L1XMOTIONTRACKER_H
@@ -0,0 +1,234 @@
+#ifndef VL53L1XSAMPLELOG_H
+#define VL53L1XSAMPLELOG_H
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+/**
+ * @brief A raw measurement packed into eight bytes.
+ *
+ * The range status and the peak signal rate share one 16-bit field: the
+ * upper 5 bits hold the VL53L1X::RangeStatus (31 for VL53L1X::None) and the
+ * lower 11 bits the signal rate in 1/8 MCPS, saturating at 255.875 MCPS.
+ */
+struct VL53L1XLogEntry {
+    uint32_t timestamp;     /**< millis() at the time the measurement was read. */
+    uint16_t distance;      /**< Distance reported by the sensor in millimeters, before any filtering. */
+    uint16_t status_signal; /**< Range status in bits 15-11, peak signal rate in 1/8 MCPS in bits 10-0. */
+
+    /**
+     * @brief Packs a measurement.
+     *
+     * @param time millis() at the time the measurement was read.
+     * @param distance_mm Distance in millimeters.
+     * @param range_status VL53L1X::RangeStatus of the measurement.
+     * @param signal_mcps Peak signal rate in MCPS, or 0 if unknown.
+     * @return The packed entry.
+     */
+    static VL53L1XLogEntry make(uint32_t time, uint16_t distance_mm, uint8_t range_status, float signal_mcps)
+    {
+        uint16_t status = range_status < 31 ? range_status : 31;
+        float scaled = signal_mcps * 8 + 0.5f;
+        uint16_t signal = scaled <= 0 ? 0 : scaled >= 0x7FF ? 0x7FF : (uint16_t)scaled;
+        VL53L1XLogEntry entry = {time, distance_mm, (uint16_t)(status << 11 | signal)};
+        return entry;
+    }
+
+    /**
+     * @brief Gets the range status.
+     *
+     * @return The VL53L1X::RangeStatus, or 31 for VL53L1X::None.
+     */
+    uint8_t getRangeStatus() const
+    {
+        return status_signal >> 11;
+    }
+
+    /**
+     * @brief Gets the peak signal rate.
+     *
+     * @return The signal rate in MCPS.
+     */
+    float getSignalRate() const
+    {
+        return (status_signal & 0x7FF) / 8.0f;
+    }
+};
+
+static_assert(sizeof(VL53L1XLogEntry) == 8, "VL53L1XLogEntry must stay eight bytes; it is streamed as is");
+
+/**
+ * @brief Lock-free single-producer, single-consumer ring buffer of raw measurements.
+ *
+ * The monitor pushes every measurement it reads, including rejected ones,
+ * so logging never takes samples away from the zones. The consumer reads
+ * the oldest entries in place with peek() and consume(), or streams them
+ * with writeFrame(). Like ZoneEventQueue, the storage is supplied by the
+ * caller or by VL53L1XSampleLogT, one slot is kept free, and entries pushed
+ * while the log is full are dropped and counted.
+ *
+ * writeFrame() emits an 8-byte header followed by the entries: the bytes
+ * 'V' 'L', format version 1, a stream id identifying the sensor, the entry
+ * count (uint16) and the low 16 bits of the dropped count (uint16). Header
+ * fields and entries are little-endian, the in-memory layout on all
+ * supported boards, so entries are written straight from the buffer.
+ */
+class VL53L1XSampleLog {
+public:
+    static const uint8_t FRAME_VERSION = 1;      /**< Version byte of frames written by writeFrame(). */
+    static const size_t FRAME_HEADER_SIZE = 8;  /**< Size of a frame header in bytes. */
+
+private:
+    VL53L1XLogEntry *buffer;        /**< Entry storage. */
+    uint16_t capacity;              /**< Number of slots in buffer. */
+    std::atomic<uint16_t> head;     /**< Next slot to write; owned by the producer. */
+    std::atomic<uint16_t> tail;     /**< Next slot to read; owned by the consumer. */
+    std::atomic<uint32_t> dropped;  /**< Entries lost because the log was full. */
+
+public:
+    /**
+     * @brief Constructs a log on caller-supplied storage.
+     *
+     * @param storage Array of at least slots entries.
+     * @param slots Number of entries in storage, between 2 and 65535; holds slots - 1 entries.
+     */
+    VL53L1XSampleLog(VL53L1XLogEntry *storage, size_t slots)
+        : buffer(storage), capacity(slots > UINT16_MAX ? UINT16_MAX : slots), head(0), tail(0), dropped(0) {}
+
+    VL53L1XSampleLog(const VL53L1XSampleLog &) = delete;
+    VL53L1XSampleLog &operator=(const VL53L1XSampleLog &) = delete;
+
+    /**
+     * @brief Appends an entry. Must only be called by the producer.
+     *
+     * @param entry The entry to append.
+     * @return True if the entry was stored, false if the log was full.
+     */
+    bool push(const VL53L1XLogEntry &entry)
+    {
+        uint16_t h = head.load(std::memory_order_relaxed);
+        uint16_t next = (h + 1 == capacity) ? 0 : h + 1;
+        if (next == tail.load(std::memory_order_acquire))
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        buffer[h] = entry;
+        head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Gets the oldest entries that are stored contiguously. Must only be called by the consumer.
+     *
+     * If the stored entries wrap around the end of the buffer, only the part
+     * up to the end is returned; call consume() and peek() again for the rest.
+     *
+     * @param entries Receives a pointer to the oldest entry; valid until consume() is called.
+     * @return The number of contiguous entries, 0 if the log is empty.
+     */
+    size_t peek(const VL53L1XLogEntry *&entries) const
+    {
+        uint16_t t = tail.load(std::memory_order_relaxed);
+        uint16_t h = head.load(std::memory_order_acquire);
+        entries = buffer + t;
+        return h >= t ? h - t : capacity - t;
+    }
+
+    /**
+     * @brief Removes the oldest entries. Must only be called by the consumer.
+     *
+     * @param count Number of entries to remove, at most the number last returned by peek().
+     */
+    void consume(size_t count)
+    {
+        size_t t = tail.load(std::memory_order_relaxed) + count;
+        tail.store((uint16_t)(t >= capacity ? t - capacity : t), std::memory_order_release);
+    }
+
+    /**
+     * @brief Writes the oldest entries as one frame and removes them. Must only be called by the consumer.
+     *
+     * The entries are written in at most two chunks straight from the
+     * buffer, so the cost per entry is a fraction of printing it. The call
+     * blocks as long as out.write() does. Nothing is written if the log is
+     * empty.
+     *
+     * @param out Destination, e.g. Serial, an SD card File or a network client.
+     * @param stream_id Identifies the sensor in the frame header.
+     * @param max_entries Maximum number of entries in the frame.
+     * @return The number of entries written.
+     */
+    size_t writeFrame(Print &out, uint8_t stream_id = 0, size_t max_entries = UINT16_MAX)
+    {
+        const VL53L1XLogEntry *first;
+        size_t first_count = peek(first);
+        size_t total = size();
+        if (total > max_entries)
+            total = max_entries;
+        if (total > UINT16_MAX)
+            total = UINT16_MAX;
+        if (first_count > total)
+            first_count = total;
+        if (total == 0)
+            return 0;
+
+        uint32_t lost = getDroppedCount();
+        uint8_t header[FRAME_HEADER_SIZE] = {'V', 'L', FRAME_VERSION, stream_id,
+                                             (uint8_t)total, (uint8_t)(total >> 8),
+                                             (uint8_t)lost, (uint8_t)(lost >> 8)};
+        out.write(header, sizeof(header));
+        out.write((const uint8_t *)first, first_count * sizeof(VL53L1XLogEntry));
+        consume(first_count);
+        if (total > first_count)
+        {
+            const VL53L1XLogEntry *second;
+            peek(second);
+            out.write((const uint8_t *)second, (total - first_count) * sizeof(VL53L1XLogEntry));
+            consume(total - first_count);
+        }
+        return total;
+    }
+
+    /**
+     * @brief Gets the number of stored entries.
+     *
+     * @return The number of entries waiting to be read.
+     */
+    size_t size() const
+    {
+        uint16_t h = head.load(std::memory_order_acquire);
+        uint16_t t = tail.load(std::memory_order_acquire);
+        return h >= t ? h - t : capacity - t + h;
+    }
+
+    /**
+     * @brief Gets the number of entries dropped because the log was full.
+     *
+     * @return The number of dropped entries.
+     */
+    uint32_t getDroppedCount() const
+    {
+        return dropped.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief VL53L1XSampleLog with built-in storage for Capacity entries.
+ *
+ * @tparam Capacity Maximum number of stored entries; each takes eight bytes.
+ */
+template <size_t Capacity>
+class VL53L1XSampleLogT : public VL53L1XSampleLog {
+    static_assert(Capacity > 0 && Capacity < UINT16_MAX, "VL53L1XSampleLogT: Capacity must be between 1 and 65534");
+
+private:
+    VL53L1XLogEntry storage[Capacity + 1]; /**< Entry storage, including the slot kept free. */
+
+public:
+    VL53L1XSampleLogT() : VL53L1XSampleLog(storage, Capacity + 1) {}
+};
+
+#endif // VL53L1XSAMPLELOG_H
@@ -0,0 +1,105 @@
+#ifndef VL53L1XSAMPLESOURCE_H
+#define VL53L1XSAMPLESOURCE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Alternative supplier of measurements and time for a monitor.
+ *
+ * A monitor with a sample source attached reads its measurements and its
+ * clock from the source instead of from the VL53L1X and millis(). This lets
+ * zone evaluation run on recorded traces, on the host or on a board without
+ * a sensor. Configuration calls such as setDistanceMode() still go to the
+ * sensor driver.
+ */
+class VL53L1XSampleSource {
+public:
+    virtual ~VL53L1XSampleSource() {}
+
+    /**
+     * @brief Reads the next measurement if one is available.
+     *
+     * @param distance Receives the distance in millimeters.
+     * @param range_status Receives the VL53L1X::RangeStatus of the measurement.
+     * @return True if a measurement was read, false if none is ready.
+     */
+    virtual bool readSample(uint16_t &distance, uint8_t &range_status) = 0;
+
+    /**
+     * @brief Gets the current time of the source.
+     *
+     * @return Time in milliseconds, used in place of millis().
+     */
+    virtual uint32_t now() const = 0;
+};
+
+/**
+ * @brief Sample source replaying a recorded distance trace.
+ *
+ * Each readSample() call returns the next distance of the trace and advances
+ * the clock by one measurement period, so a trace replays as fast as
+ * update() is called. The trace is not copied and must outlive the source.
+ */
+class VL53L1XReplaySource : public VL53L1XSampleSource {
+private:
+    const uint16_t *trace;    /**< Recorded distances in millimeters. */
+    size_t trace_length;      /**< Number of distances in trace. */
+    size_t position;          /**< Next distance to return. */
+    uint32_t period_ms;       /**< Clock advance per measurement. */
+    uint32_t clock_ms;        /**< Current time of the source. */
+    bool looping;             /**< Whether the trace restarts after its last distance. */
+
+public:
+    /**
+     * @brief Constructs a replay source.
+     *
+     * @param distances Recorded distances in millimeters.
+     * @param count Number of distances.
+     * @param period Time between two measurements in milliseconds.
+     * @param loop Restart at the first distance after the last one.
+     */
+    VL53L1XReplaySource(const uint16_t *distances, size_t count, uint32_t period, bool loop = false)
+        : trace(distances), trace_length(count), position(0), period_ms(period), clock_ms(0), looping(loop)
+    {
+    }
+
+    bool readSample(uint16_t &distance, uint8_t &range_status) override
+    {
+        if (position >= trace_length)
+        {
+            if (!looping || trace_length == 0)
+                return false;
+            position = 0;
+        }
+        distance = trace[position++];
+        range_status = 0; // VL53L1X::RangeValid
+        clock_ms += period_ms;
+        return true;
+    }
+
+    uint32_t now() const override
+    {
+        return clock_ms;
+    }
+
+    /**
+     * @brief Checks whether a non-looping trace has been fully replayed.
+     *
+     * @return True if no distances are left.
+     */
+    bool finished() const
+    {
+        return !looping && position >= trace_length;
+    }
+
+    /**
+     * @brief Restarts the trace at its first distance. The clock keeps running.
+     */
+    void rewind()
+    {
+        position = 0;
+    }
+};
+
+#endif // VL53L1XSAMPLESOURCE_H
@@ -3,14 +3,22 @@
 // This file contains the implementation of the VL53L1XZoneMonitor and ZoneObserver classes.
 
 #include "VL53L1XZoneMonitor.h"
+#include <string.h>
 
-ZoneObserver::ZoneObserver(uint16_t min, uint16_t max, std::function<void(uint16_t)> onEnter, std::function<void()> onExit)
-    : min_distance(min), max_distance(max), object_present(false), on_enter(std::move(onEnter)), on_exit(std::move(onExit)),
-      in_zone_count(0), out_zone_count(0) {}
+#if defined(ESP32) || defined(ESP8266)
+#define VL53L1XZONEMONITOR_ISR_ATTR IRAM_ATTR
+#else
+#define VL53L1XZONEMONITOR_ISR_ATTR
+#endif
+
+ZoneObserver::ZoneObserver(uint16_t min, uint16_t max, ZoneEnterCallback onEnter, ZoneExitCallback onExit)
+    : min_distance(min), max_distance(max), object_present(false), on_enter(onEnter), on_exit(onExit),
+      in_zone_count(0), out_zone_count(0), hysteresis(0) {}
 
 void ZoneObserver::evaluate(uint16_t distance, size_t certainty)
 {
-    bool in_zone = (distance >= min_distance && distance <= max_distance);
+    uint16_t margin = object_present ? hysteresis : 0;
+    bool in_zone = ((uint32_t)distance + margin >= min_distance && distance <= (uint32_t)max_distance + margin);
     if (in_zone)
     {
         in_zone_count++;
@@ -40,142 +48,3233 @@ bool ZoneObserver::isObjectPresent() const
     return object_present;
 }
 
-VL53L1XZoneMonitor::VL53L1XZoneMonitor(TwoWire *wire, uint32_t interval_ms, size_t certainty)
-    : update_interval_ms(interval_ms), last_update_time(0), certainty_factor(certainty)
+uint16_t ZoneView::getMinDistance() const
+{
+    return monitor->zone_min[zone_index];
+}
+
+uint16_t ZoneView::getMaxDistance() const
+{
+    return monitor->zone_max[zone_index];
+}
+
+uint8_t ZoneView::getInZoneCount() const
+{
+    return monitor->zone_in_count[zone_index];
+}
+
+uint8_t ZoneView::getOutZoneCount() const
+{
+    return monitor->zone_out_count[zone_index];
+}
+
+uint16_t ZoneView::getHysteresis() const
+{
+    return monitor->zone_hysteresis[zone_index];
+}
+
+uint8_t ZoneView::getCertainty() const
+{
+    return monitor->zone_certainty[zone_index];
+}
+
+uint8_t ZoneView::getRoi() const
+{
+    return monitor->zone_roi[zone_index];
+}
+
+bool ZoneView::isObjectPresent() const
+{
+    return VL53L1XZoneMonitorBase::testBit(monitor->zone_present, zone_index);
+}
+
+bool ZoneView::isApproaching() const
+{
+    return VL53L1XZoneMonitorBase::testBit(monitor->zone_approaching, zone_index);
+}
+
+bool ZoneView::isKnown() const
+{
+#if VL53L1XZONEMONITOR_ENABLE_FAULT_RECOVERY
+    return monitor->health != VL53L1XZoneMonitorBase::Recovering;
+#else
+    return true;
+#endif
+}
+
+VL53L1XZoneMonitorBase *volatile VL53L1XZoneMonitorBase::interrupt_owners[VL53L1XZoneMonitorBase::MAX_INTERRUPT_MONITORS] = {};
+
+VL53L1XZoneMonitorBase::VL53L1XZoneMonitorBase(TwoWire *wire, uint32_t interval_ms, size_t certainty)
+    : update_interval_ms(interval_ms), current_interval_ms(interval_ms), last_update_time(0), certainty_factor(certainty),
+      interrupt_pin(NO_INTERRUPT_PIN), data_ready_flag(false), index_dirty(false), zones_moved(false), index_valid(false),
+      event_queue(nullptr), next_generation(0), sample_source(nullptr),
+#if VL53L1XZONEMONITOR_ENABLE_SAMPLE_LOG
+      sample_log(nullptr),
+#endif
+      accepted_statuses(ALL_RANGE_STATUSES),
+      min_signal_rate(0), max_ambient_rate(0), min_confidence(0), roi_count(0), roi_position(0), settling(false),
+#if VL53L1XZONEMONITOR_ENABLE_MOTION
+      motion_tracking(false), approach_lead_ms(0),
+#endif
+#if VL53L1XZONEMONITOR_ENABLE_BACKGROUND
+      background_suppression(false),
+#endif
+#if VL53L1XZONEMONITOR_MAX_COUNTERS > 0
+      counter_count(0),
+#endif
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+      group_count(0), group_changes(0),
+#endif
+      bus_lock(nullptr), bus_wait_ms(0), bus_budget_us(0), bus_lock_depth(0),
+      async_read(false), driver_calibrated(false), config_depth(0), driver_initialized(false),
+      restored_distance_mode(VL53L1X::Long), timing_budget_us(0), idle_interval_ms(0), idle_budget_us(0), active_budget_us(0), activity_hold_ms(0),
+      last_activity_time(0), idle_sampling(false), ranging(false),
+#if VL53L1XZONEMONITOR_ENABLE_FAULT_RECOVERY
+      fault_recovery(false), health(Healthy), reported_health(Healthy), unknown_zones_pending(false),
+      unknown_policy(KeepLastState), shutdown_pin(NO_SHUTDOWN_PIN), max_faults(1), fault_count(0), recovery_phase(RecoverWait),
+      recovery_address(DEFAULT_ADDRESS), recovery_time(0), recovery_delay_ms(0), max_backoff_ms(0),
+#endif
+      last_read_time(0),
+      single_shot(false),
+#if VL53L1XZONEMONITOR_ENABLE_SINGLE_SHOT
+      shot_pending(false), shot_time(0), next_shot_time(0),
+#endif
+#if defined(ESP32)
+      acquisition_task(nullptr), state_mutex(nullptr), config_mutex(nullptr),
+#endif
+      zone_min(nullptr), zone_max(nullptr), zone_in_count(nullptr), zone_out_count(nullptr), zone_hysteresis(nullptr),
+      zone_certainty(nullptr), zone_roi(nullptr), zone_present(nullptr), zone_approaching(nullptr),
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+      zone_groups(nullptr),
+#endif
+      zone_generation(nullptr), zone_used(nullptr), zone_callbacks(nullptr),
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+      zone_callback_us(nullptr),
+#endif
+      zone_slots(0), index_bounds(nullptr), index_offsets(nullptr),
+      index_members(nullptr), active_zones(nullptr), candidate_zones(nullptr), index_bound_count(0), active_count(0)
 {
+    last_sample.distance = 0;
+    last_sample.raw_distance = 0;
+    last_sample.range_status = VL53L1X::None;
+    last_sample.valid = false;
+    last_sample.background = false;
+    last_sample.roi = 0;
+    last_sample.velocity = 0;
+    last_sample.confidence = 0;
+    pending_read.phase = ReadIdle;
+    last_sample.timestamp = 0;
+    last_sample.sequence = 0;
     if (wire)
     {
         sensor.setBus(wire);
     }
 }
 
-bool VL53L1XZoneMonitor::init()
+VL53L1XZoneMonitorBase::~VL53L1XZoneMonitorBase()
 {
-    if (!sensor.init())
-        return false;
-    sensor.startContinuous(update_interval_ms);
-    return true;
+#if defined(ESP32)
+    stopTask();
+    if (state_mutex)
+        vSemaphoreDelete(state_mutex);
+#endif
+    detachDataReadyInterrupt();
 }
 
-void VL53L1XZoneMonitor::setDistanceMode(VL53L1X::DistanceMode mode)
+VL53L1XZoneMonitorBase::StateLock::StateLock(const VL53L1XZoneMonitorBase &monitor)
+#if defined(ESP32)
+    : mutex(monitor.state_mutex)
 {
-    sensor.setDistanceMode(mode);
+    if (mutex)
+        xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 }
-
-VL53L1X::DistanceMode VL53L1XZoneMonitor::getDistanceMode()
+#else
 {
-    return sensor.getDistanceMode();
+    (void)monitor;
 }
+#endif
 
-void VL53L1XZoneMonitor::setMeasurementTimingBudget(uint32_t budget_us)
+VL53L1XZoneMonitorBase::StateLock::~StateLock()
 {
-    sensor.setMeasurementTimingBudget(budget_us);
+#if defined(ESP32)
+    if (mutex)
+        xSemaphoreGiveRecursive(mutex);
+#endif
 }
 
-uint32_t VL53L1XZoneMonitor::getMeasurementTimingBudget()
+VL53L1XZoneMonitorBase::BusGuard::BusGuard(VL53L1XZoneMonitorBase &monitor, uint32_t timeout_ms)
+    : owner(monitor), lock(nullptr), held(true)
 {
-    return sensor.getMeasurementTimingBudget();
+    if (!owner.bus_lock)
+        return;
+    if (owner.bus_lock_depth == 0 && !owner.bus_lock->acquire(timeout_ms))
+    {
+        held = false;
+        return;
+    }
+    lock = owner.bus_lock;
+    owner.bus_lock_depth++;
 }
 
-void VL53L1XZoneMonitor::setTimeout(uint16_t timeout)
+VL53L1XZoneMonitorBase::BusGuard::~BusGuard()
 {
-    sensor.setTimeout(timeout);
+    if (lock && --owner.bus_lock_depth == 0)
+        lock->release();
 }
 
-uint16_t VL53L1XZoneMonitor::getTimeout()
+bool VL53L1XZoneMonitorBase::BusGuard::isHeld() const
 {
-    return sensor.getTimeout();
+    return held;
 }
 
-void VL53L1XZoneMonitor::addZone(uint16_t min, uint16_t max, std::function<void(uint16_t)> onEnter, std::function<void()> onExit)
+bool VL53L1XZoneMonitorBase::init(uint8_t pin)
 {
-    zones.emplace_back(min, max, std::move(onEnter), std::move(onExit));
+    detachDataReadyInterrupt();
+    {
+        BusGuard bus(*this, VL53L1XBusLock::WAIT_FOREVER);
+        if (!sensor.init())
+            return false;
+        driver_initialized = true;
+        timing_budget_us = sensor.getMeasurementTimingBudget();
+        idle_sampling = false;
+        current_interval_ms = update_interval_ms;
+        if (!single_shot)
+            sensor.startContinuous(current_interval_ms);
+        ranging = true;
+        resetReadState();
+#if VL53L1XZONEMONITOR_ENABLE_FAULT_RECOVERY
+        fault_count = 0;
+        unknown_zones_pending = false;
+        setHealth(Healthy);
+#endif
+    }
+#if VL53L1XZONEMONITOR_ENABLE_FAULT_RECOVERY
+    reportFaultState();
+#endif
+    return useInterruptPin(pin);
 }
 
-bool VL53L1XZoneMonitor::isObjectInZone(size_t zone_index)
+bool VL53L1XZoneMonitorBase::useInterruptPin(uint8_t pin)
 {
-    performUpdate();
-    if (zone_index < zones.size())
+    if (pin != NO_INTERRUPT_PIN)
     {
-        return zones[zone_index].isObjectPresent();
+        interrupt_pin = pin;
+        if (!attachDataReadyInterrupt())
+        {
+            interrupt_pin = NO_INTERRUPT_PIN;
+            return false;
+        }
     }
-    return false;
+    return true;
+}
+
+void VL53L1XZoneMonitorBase::setAddress(uint8_t address)
+{
+    StateLock lock(*this);
+    BusGuard bus(*this, VL53L1XBusLock::WAIT_FOREVER);
+    sensor.setAddress(address);
+}
+
+uint8_t VL53L1XZoneMonitorBase::getAddress()
+{
+    return sensor.getAddress();
+}
+
+void VL53L1XZoneMonitorBase::startRanging()
+{
+    StateLock lock(*this);
+    BusGuard bus(*this, VL53L1XBusLock::WAIT_FOREVER);
+    ranging = true;
+    if (!ensureDriverInitialized())
+        return;
+    if (!single_shot)
+        sensor.startContinuous(current_interval_ms);
+    resetReadState();
+}
+
+void VL53L1XZoneMonitorBase::stopRanging()
+{
+    StateLock lock(*this);
+    BusGuard bus(*this, VL53L1XBusLock::WAIT_FOREVER);
+    ranging = false;
+    sensor.stopContinuous();
+    resetReadState();
+}
+
+#if VL53L1XZONEMONITOR_ENABLE_SINGLE_SHOT
+void VL53L1XZoneMonitorBase::enableSingleShot()
+{
+    StateLock lock(*this);
+    applyRangingMode(true);
+}
+
+void VL53L1XZoneMonitorBase::disableSingleShot()
+{
+    StateLock lock(*this);
+    applyRangingMode(false);
+}
+#endif
+
+bool VL53L1XZoneMonitorBase::isSingleShot() const
+{
+    return single_shot;
+}
+
+#if VL53L1XZONEMONITOR_ENABLE_SINGLE_SHOT
+
+void VL53L1XZoneMonitorBase::applyRangingMode(bool single)
+{
+    if (single == single_shot)
+        return;
+    BusGuard bus(*this, VL53L1XBusLock::WAIT_FOREVER);
+    single_shot = single;
+    // Stopping needs no calibration, so a warm start can switch without the driver's initialization.
+    sensor.stopContinuous();
+    if (ranging && !single_shot && ensureDriverInitialized())
+        sensor.startContinuous(current_interval_ms);
+    resetReadState();
+    data_ready_flag = false;
+    settling = ranging && !single_shot && sample_source == nullptr;
+}
+#endif
+
+uint32_t VL53L1XZoneMonitorBase::getNextWakeDelay() const
+{
+    StateLock lock(*this);
+    uint32_t deadline;
+#if VL53L1XZONEMONITOR_ENABLE_FAULT_RECOVERY
+    if (health == Recovering)
+        deadline = recovery_time + (recovery_phase == RecoverWait ? recovery_delay_ms : 0);
+    else
+#endif
+    if (!ranging)
+        return UINT32_MAX;
+#if VL53L1XZONEMONITOR_ENABLE_SINGLE_SHOT
+    else if (!single_shot)
+        deadline = last_read_time + current_interval_ms;
+    else if (shot_pending)
+        deadline = shot_time + timing_budget_us / 1000 + SHOT_MARGIN_MS;
+    else
+        deadline = next_shot_time;
+#else
+    else
+        deadline = last_read_time + current_interval_ms;
+#endif
+    int32_t remaining = (int32_t)(deadline - millis());
+    return remaining > 0 ? (uint32_t)remaining : 0;
 }
 
-size_t VL53L1XZoneMonitor::getZoneCount() const
+template <uint8_t Slot>
+void VL53L1XZONEMONITOR_ISR_ATTR VL53L1XZoneMonitorBase::dataReadyTrampoline()
 {
-    return zones.size();
+    handleDataReadyInterrupt(Slot);
 }
 
-ZoneObserver *VL53L1XZoneMonitor::getZone(size_t zone_index)
+void VL53L1XZONEMONITOR_ISR_ATTR VL53L1XZoneMonitorBase::handleDataReadyInterrupt(uint8_t slot)
 {
-    if (zone_index < zones.size())
+    VL53L1XZoneMonitorBase *owner = interrupt_owners[slot];
+    if (owner)
     {
-        return &zones[zone_index];
+        owner->data_ready_flag = true;
+#if defined(ESP32)
+        if (owner->acquisition_task)
+        {
+            BaseType_t woken = pdFALSE;
+            vTaskNotifyGiveFromISR(owner->acquisition_task, &woken);
+            if (woken == pdTRUE)
+            {
+                portYIELD_FROM_ISR();
+            }
+        }
+#endif
     }
-    return nullptr;
 }
 
-void VL53L1XZoneMonitor::updateZone(size_t zone_index, uint16_t min_distance, uint16_t max_distance)
+bool VL53L1XZoneMonitorBase::attachDataReadyInterrupt()
 {
-    if (zone_index < zones.size())
+    static void (*const trampolines[MAX_INTERRUPT_MONITORS])() = {
+        dataReadyTrampoline<0>, dataReadyTrampoline<1>, dataReadyTrampoline<2>, dataReadyTrampoline<3>,
+        dataReadyTrampoline<4>, dataReadyTrampoline<5>, dataReadyTrampoline<6>, dataReadyTrampoline<7>};
+
+    int irq = digitalPinToInterrupt(interrupt_pin);
+    if (irq == NOT_AN_INTERRUPT)
+        return false;
+
+    for (uint8_t slot = 0; slot < MAX_INTERRUPT_MONITORS; slot++)
     {
-        if (min_distance != 0)
+        if (interrupt_owners[slot] == nullptr)
         {
-            zones[zone_index].min_distance = min_distance;
+            interrupt_owners[slot] = this;
+            pinMode(interrupt_pin, INPUT);
+            // GPIO1 is active low and stays low until the result is read, so a
+            // measurement that completed before the interrupt was attached is
+            // picked up from the pin level instead of waiting for the next edge.
+            data_ready_flag = false;
+            attachInterrupt(irq, trampolines[slot], FALLING);
+            if (digitalRead(interrupt_pin) == LOW)
+                data_ready_flag = true;
+            return true;
         }
+    }
+    return false;
+}
 
-        if (max_distance != 0)
+void VL53L1XZoneMonitorBase::detachDataReadyInterrupt()
+{
+    if (interrupt_pin == NO_INTERRUPT_PIN)
+        return;
+
+    for (uint8_t slot = 0; slot < MAX_INTERRUPT_MONITORS; slot++)
+    {
+        if (interrupt_owners[slot] == this)
         {
-            zones[zone_index].max_distance = max_distance;
+            detachInterrupt(digitalPinToInterrupt(interrupt_pin));
+            interrupt_owners[slot] = nullptr;
         }
     }
+    interrupt_pin = NO_INTERRUPT_PIN;
+    data_ready_flag = false;
+}
+
+bool VL53L1XZoneMonitorBase::setDistanceMode(VL53L1X::DistanceMode mode)
+{
+    StateLock lock(*this);
+    return reconfigure(mode, idle_sampling ? active_budget_us : timing_budget_us, update_interval_ms);
+}
+
+VL53L1X::DistanceMode VL53L1XZoneMonitorBase::getDistanceMode()
+{
+    if (!driver_initialized)
+        return (VL53L1X::DistanceMode)restored_distance_mode;
+    return sensor.getDistanceMode();
+}
+
+bool VL53L1XZoneMonitorBase::setMeasurementTimingBudget(uint32_t budget_us)
+{
+    StateLock lock(*this);
+    return reconfigure(getDistanceMode(), budget_us, update_interval_ms);
+}
+
+bool VL53L1XZoneMonitorBase::reconfigure(VL53L1X::DistanceMode mode, uint32_t budget_us, uint32_t interval_ms)
+{
+    if (!fitsInterval(budget_us, interval_ms))
+        return false;
+
+    StateLock lock(*this);
+    if (idle_sampling)
+    {
+        // Budget and interval are applied when sampling speeds up again.
+        if (mode != getDistanceMode() && !applySamplingProfile(mode, current_interval_ms, timing_budget_us))
+            return false;
+    }
+    else if (!applySamplingProfile(mode, interval_ms, budget_us))
+    {
+        return false;
+    }
+    update_interval_ms = interval_ms;
+    active_budget_us = budget_us;
+    return true;
+}
+
+uint32_t VL53L1XZoneMonitorBase::getMeasurementTimingBudget()
+{
+    StateLock lock(*this);
+    if (!driver_initialized)
+        return timing_budget_us;
+    BusGuard bus(*this, VL53L1XBusLock::WAIT_FOREVER);
+    return sensor.getMeasurementTimingBudget();
+}
+
+bool VL53L1XZoneMonitorBase::enableAdaptiveSampling(uint32_t idle_interval, uint32_t idle_budget, uint32_t hold_ms)
+{
+    if (!fitsInterval(idle_budget, idle_interval))
+        return false;
+
+    StateLock lock(*this);
+    if (idle_interval_ms == 0)
+        active_budget_us = getMeasurementTimingBudget();
+    idle_interval_ms = idle_interval;
+    idle_budget_us = idle_budget;
+    activity_hold_ms = hold_ms;
+    last_activity_time = currentTime();
+    if (idle_sampling)
+        applySamplingProfile(getDistanceMode(), idle_interval_ms, idle_budget_us);
+    return true;
+}
+
+void VL53L1XZoneMonitorBase::disableAdaptiveSampling()
+{
+    StateLock lock(*this);
+    if (idle_sampling)
+        applySamplingProfile(getDistanceMode(), update_interval_ms, active_budget_us);
+    idle_sampling = false;
+    idle_interval_ms = 0;
+}
+
+bool VL53L1XZoneMonitorBase::isIdleSampling() const
+{
+    return idle_sampling;
+}
+
+#if VL53L1XZONEMONITOR_ENABLE_MOTION
+bool VL53L1XZoneMonitorBase::enableMotionTracking(uint16_t lead_ms, uint8_t alpha, uint8_t beta)
+{
+    StateLock lock(*this);
+    for (uint8_t r = 0; r < MAX_ROIS; r++)
+    {
+        if (!trackers[r].configure(alpha, beta))
+            return false;
+    }
+    motion_tracking = true;
+    approach_lead_ms = lead_ms;
+    std::fill(zone_approaching, zone_approaching + (zone_slots + 7) / 8, 0);
+    return true;
+}
+
+void VL53L1XZoneMonitorBase::disableMotionTracking()
+{
+    StateLock lock(*this);
+    motion_tracking = false;
+    approach_lead_ms = 0;
+    last_sample.velocity = 0;
+    std::fill(zone_approaching, zone_approaching + (zone_slots + 7) / 8, 0);
+}
+
+int16_t VL53L1XZoneMonitorBase::getVelocity(uint8_t roi) const
+{
+    if (!motion_tracking || roi >= MAX_ROIS)
+        return 0;
+    return trackers[roi].getVelocity();
 }
+#endif
 
-void VL53L1XZoneMonitor::deleteZone(size_t zone_index)
+#if VL53L1XZONEMONITOR_ENABLE_BACKGROUND
+bool VL53L1XZoneMonitorBase::enableBackgroundSuppression(uint16_t tolerance_mm, uint32_t absorb_ms, uint8_t adapt_shift)
 {
-    if (zone_index < zones.size())
+    StateLock lock(*this);
+    for (uint8_t r = 0; r < MAX_ROIS; r++)
     {
-        zones.erase(zones.begin() + zone_index);
+        if (!backgrounds[r].configure(tolerance_mm, absorb_ms, adapt_shift))
+            return false;
     }
+    background_suppression = true;
+    return true;
+}
+
+void VL53L1XZoneMonitorBase::disableBackgroundSuppression()
+{
+    StateLock lock(*this);
+    background_suppression = false;
+    last_sample.background = false;
+}
+
+void VL53L1XZoneMonitorBase::relearnBackground()
+{
+    StateLock lock(*this);
+    for (uint8_t r = 0; r < MAX_ROIS; r++)
+        backgrounds[r].reset();
+}
+
+uint16_t VL53L1XZoneMonitorBase::getBackgroundDistance(uint8_t roi) const
+{
+    if (!background_suppression || roi >= MAX_ROIS)
+        return 0;
+    return backgrounds[roi].getBaseline();
+}
+#endif
+
+void VL53L1XZoneMonitorBase::setTimeout(uint16_t timeout)
+{
+    StateLock lock(*this);
+    sensor.setTimeout(timeout);
+}
+
+uint16_t VL53L1XZoneMonitorBase::getTimeout()
+{
+    return sensor.getTimeout();
 }
 
-uint16_t VL53L1XZoneMonitor::getDistance()
+// Configuration blob layout, all fields little-endian:
+// magic (2), version (1), reserved (1), total size (2), settings, zone table, CRC-16 (2).
+static const uint16_t CONFIG_MAGIC = 0x5A56; // "VZ"
+static const uint8_t CONFIG_VERSION = 1;
+static const size_t CONFIG_HEADER_SIZE = 6;
+static const size_t CONFIG_ADDRESS_OFFSET = CONFIG_HEADER_SIZE;
+
+/**
+ * @brief Serializes configuration fields, only counting them if no buffer is given.
+ */
+struct ConfigWriter
+{
+    uint8_t *buffer;
+    size_t capacity;
+    size_t size;
+
+    void put8(uint8_t value)
+    {
+        if (buffer && size < capacity)
+            buffer[size] = value;
+        size++;
+    }
+
+    void put16(uint16_t value)
+    {
+        put8((uint8_t)value);
+        put8((uint8_t)(value >> 8));
+    }
+
+    void put32(uint32_t value)
+    {
+        put16((uint16_t)value);
+        put16((uint16_t)(value >> 16));
+    }
+
+    void putFloat(float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        put32(bits);
+    }
+};
+
+/**
+ * @brief Deserializes configuration fields; reads past the end return 0 and clear ok.
+ */
+struct ConfigReader
+{
+    const uint8_t *data;
+    size_t size;
+    size_t position;
+    bool ok;
+
+    uint8_t get8()
+    {
+        if (position >= size)
+        {
+            ok = false;
+            return 0;
+        }
+        return data[position++];
+    }
+
+    uint16_t get16()
+    {
+        uint16_t low = get8();
+        return (uint16_t)(low | (uint16_t)get8() << 8);
+    }
+
+    uint32_t get32()
+    {
+        uint32_t low = get16();
+        return low | (uint32_t)get16() << 16;
+    }
+
+    float getFloat()
+    {
+        uint32_t bits = get32();
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+};
+
+// CRC-16/CCITT-FALSE, bitwise to avoid a lookup table in flash.
+static uint16_t configChecksum(const uint8_t *data, size_t size)
 {
-    if (sensor.dataReady())
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < size; i++)
     {
-        return sensor.read(false);
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+            crc = crc & 0x8000 ? (uint16_t)(crc << 1 ^ 0x1021) : (uint16_t)(crc << 1);
     }
-    return 0;
+    return crc;
 }
 
-void VL53L1XZoneMonitor::setCertaintyFactor(size_t certainty)
+size_t VL53L1XZoneMonitorBase::saveConfig(uint8_t *buffer, size_t buffer_size)
 {
-    certainty_factor = certainty;
+    StateLock lock(*this);
+    ConfigWriter writer = {buffer, buffer_size, 0};
+    writer.put16(CONFIG_MAGIC);
+    writer.put8(CONFIG_VERSION);
+    writer.put8(0);
+    writer.put16(0); // Total size, patched below.
+
+    writer.put8(sensor.getAddress());
+    writer.put8((uint8_t)getDistanceMode());
+    writer.put16(sensor.getTimeout());
+    writer.put32(update_interval_ms);
+    writer.put32(idle_interval_ms != 0 ? active_budget_us : getMeasurementTimingBudget());
+    writer.put16((uint16_t)std::min(certainty_factor, (size_t)UINT16_MAX));
+    writer.put32(accepted_statuses);
+    writer.putFloat(min_signal_rate);
+    writer.putFloat(max_ambient_rate);
+#if VL53L1XZONEMONITOR_ENABLE_PREFILTER
+    writer.put8((uint8_t)prefilters[0].getMode());
+    writer.put8(prefilters[0].getParameter());
+#else
+    writer.put8((uint8_t)VL53L1XDistanceFilter::None);
+    writer.put8(0);
+#endif
+    writer.put8((async_read ? 1 : 0) | (single_shot ? 2 : 0));
+    writer.put32(idle_interval_ms);
+    writer.put32(idle_budget_us);
+    writer.put32(activity_hold_ms);
+    writer.put8(roi_count);
+    for (uint8_t r = 0; r < roi_count; r++)
+    {
+        writer.put8(rois[r].width);
+        writer.put8(rois[r].height);
+        writer.put8(rois[r].center);
+    }
+
+    writer.put16((uint16_t)zone_slots);
+    for (size_t i = 0; i < zone_slots; i++)
+    {
+        bool used = isZoneSlotUsed(i);
+        writer.put8(used ? 1 : 0);
+        if (!used)
+            continue;
+        writer.put16(zone_min[i]);
+        writer.put16(zone_max[i]);
+        writer.put16(zone_hysteresis[i]);
+        writer.put8(zone_certainty[i]);
+        writer.put8(zone_roi[i]);
+    }
+
+    size_t size = writer.size + 2;
+    if (!buffer)
+        return size;
+    if (size > buffer_size || size > UINT16_MAX)
+        return 0;
+    buffer[4] = (uint8_t)size;
+    buffer[5] = (uint8_t)(size >> 8);
+    writer.put16(configChecksum(buffer, writer.size));
+    return size;
 }
 
-size_t VL53L1XZoneMonitor::getCertaintyFactor() const
+bool VL53L1XZoneMonitorBase::isValidConfig(const uint8_t *data, size_t size)
 {
-    return certainty_factor;
+    if (!data || size < CONFIG_HEADER_SIZE + 2)
+        return false;
+    ConfigReader reader = {data, size, 0, true};
+    if (reader.get16() != CONFIG_MAGIC || reader.get8() != CONFIG_VERSION)
+        return false;
+    reader.get8();
+    if (reader.get16() != size)
+        return false;
+    uint16_t crc = (uint16_t)(data[size - 2] | (uint16_t)data[size - 1] << 8);
+    return configChecksum(data, size - 2) == crc;
 }
 
-void VL53L1XZoneMonitor::performUpdate()
+bool VL53L1XZoneMonitorBase::applyConfig(const uint8_t *data, bool to_sensor)
 {
-    if (millis() - last_update_time >= update_interval_ms)
+    ConfigReader reader = {data, (size_t)(data[4] | (size_t)data[5] << 8) - 2, CONFIG_ADDRESS_OFFSET, true};
+    uint8_t address = reader.get8();
+    uint8_t distance_mode = reader.get8();
+    uint16_t timeout = reader.get16();
+    uint32_t interval_ms = reader.get32();
+    uint32_t budget_us = reader.get32();
+    uint16_t certainty = reader.get16();
+    uint32_t status_mask = reader.get32();
+    float min_signal = reader.getFloat();
+    float max_ambient = reader.getFloat();
+    uint8_t prefilter_mode = reader.get8();
+    uint8_t prefilter_param = reader.get8();
+    uint8_t flags = reader.get8();
+    uint32_t idle_interval = reader.get32();
+    uint32_t idle_budget = reader.get32();
+    uint32_t hold_ms = reader.get32();
+    VL53L1XRoi roi_list[MAX_ROIS];
+    uint8_t count = reader.get8();
+    if (count > MAX_ROIS || distance_mode > VL53L1X::Long || prefilter_mode > VL53L1XDistanceFilter::Ema)
+        return false;
+    for (uint8_t r = 0; r < count; r++)
+    {
+        roi_list[r].width = reader.get8();
+        roi_list[r].height = reader.get8();
+        roi_list[r].center = reader.get8();
+        if (roi_list[r].width < 4 || roi_list[r].width > 16 || roi_list[r].height < 4 || roi_list[r].height > 16)
+            return false;
+    }
+
+    // The zone table is checked in full before anything is changed, so a
+    // rejected blob leaves the existing zones in place.
+    size_t slots = reader.get16();
+    size_t table = reader.position;
+    for (size_t i = 0; i < slots && reader.ok; i++)
+    {
+        if (reader.get8() != 0)
+            reader.position += 8;
+    }
+    if (!reader.ok || reader.position != reader.size)
+        return false;
+
+    StateLock lock(*this);
+    if (slots > getZoneCapacity())
+        return false;
+    BusGuard bus(*this, VL53L1XBusLock::WAIT_FOREVER);
+    if (to_sensor)
+    {
+        // The sampling profile is the only step the sensor can refuse; it is
+        // applied first and restores the previous mode itself on failure.
+        if ((idle_sampling || distance_mode != (uint8_t)sensor.getDistanceMode() || interval_ms != current_interval_ms ||
+             budget_us != sensor.getMeasurementTimingBudget()) &&
+            !applySamplingProfile((VL53L1X::DistanceMode)distance_mode, interval_ms, budget_us))
+            return false;
+        sensor.setTimeout(timeout);
+        if (address != sensor.getAddress())
+            sensor.setAddress(address);
+        setRoiScan(roi_list, count);
+#if VL53L1XZONEMONITOR_ENABLE_SINGLE_SHOT
+        applyRangingMode((flags & 2) != 0);
+#endif
+    }
+    else
     {
-        last_update_time = millis();
-        if (sensor.dataReady())
+        sensor.setTimeout(timeout);
+        restored_distance_mode = distance_mode;
+        timing_budget_us = budget_us;
+        current_interval_ms = interval_ms;
+        for (uint8_t r = 0; r < count; r++)
+            rois[r] = roi_list[r];
+        roi_count = count;
+        roi_position = 0;
+        settling = false;
+#if VL53L1XZONEMONITOR_ENABLE_SINGLE_SHOT
+        single_shot = (flags & 2) != 0;
+#endif
+        if (count > 1)
         {
-            uint16_t distance = sensor.read(false);
-            for (auto &zone : zones)
-            {
-                zone.evaluate(distance, certainty_factor);
-            }
+            // The scan position at sleep is unknown; restart it at the first region.
+            sensor.setROISize(rois[0].width, rois[0].height);
+            sensor.setROICenter(rois[0].center);
+            settling = true;
+        }
+    }
+    update_interval_ms = interval_ms;
+    idle_sampling = false;
+    certainty_factor = certainty;
+    accepted_statuses = status_mask;
+    min_signal_rate = min_signal;
+    max_ambient_rate = max_ambient;
+#if VL53L1XZONEMONITOR_ENABLE_PREFILTER
+    for (uint8_t r = 0; r < MAX_ROIS; r++)
+        prefilters[r].configure((VL53L1XDistanceFilter::Mode)prefilter_mode, prefilter_param);
+#else
+    (void)prefilter_param;
+#endif
+    async_read = (flags & 1) != 0;
+    idle_interval_ms = idle_interval;
+    idle_budget_us = idle_budget;
+    activity_hold_ms = hold_ms;
+    active_budget_us = budget_us;
+    last_activity_time = currentTime();
+
+    beginConfig();
+    for (size_t i = zone_slots; i > 0; i--)
+        deleteZone(i - 1);
+    reader.position = table;
+    for (size_t i = 0; i < slots; i++)
+    {
+        bool used = reader.get8() != 0;
+        uint16_t min = used ? reader.get16() : 0;
+        uint16_t max = used ? reader.get16() : 0;
+        addZone(min, max, ZoneEnterCallback(), ZoneExitCallback());
+        if (used)
+        {
+            zone_hysteresis[i] = reader.get16();
+            zone_certainty[i] = reader.get8();
+            zone_roi[i] = std::min(reader.get8(), (uint8_t)(MAX_ROIS - 1));
         }
     }
+    // Unused saved slots were filled with placeholders so that the zones
+    // after them keep their indices; deleting them inside the transaction
+    // leaves the indices unchanged.
+    reader.position = table;
+    for (size_t i = 0; i < slots; i++)
+    {
+        if (reader.get8() != 0)
+            reader.position += 8;
+        else
+            deleteZone(i);
+    }
+    commit();
+    return true;
+}
+
+bool VL53L1XZoneMonitorBase::restoreConfig(const uint8_t *data, size_t size)
+{
+    return isValidConfig(data, size) && applyConfig(data, true);
+}
+
+bool VL53L1XZoneMonitorBase::initFromConfig(const uint8_t *data, size_t size, uint8_t pin)
+{
+    if (!isValidConfig(data, size))
+        return false;
+    // The driver can only reach the sensor at its current address, so only
+    // a blob saved at that address can take the warm path.
+    detachDataReadyInterrupt();
+    BusGuard bus(*this, VL53L1XBusLock::WAIT_FOREVER);
+    if (data[CONFIG_ADDRESS_OFFSET] == sensor.getAddress() &&
+        sensor.readReg16Bit(VL53L1X::IDENTIFICATION__MODEL_ID) == 0xEACC && sensor.last_status == 0)
+    {
+        driver_initialized = false;
+        if (!applyConfig(data, false))
+            return false;
+        ranging = true;
+        resetReadState();
+        return useInterruptPin(pin);
+    }
+    return init(pin) && applyConfig(data, true);
+}
+
+// Zone state blob layout, all fields little-endian: magic (2), version (1),
+// flags (1), zone slots (2), counters (1), in and out counts per slot,
+// presence bitset, passage progress, direction and in and out passages per
+// counter (10), CRC-16 (2).
+static const uint16_t STATE_MAGIC = 0x5356; // "VS"
+static const uint8_t STATE_VERSION = 1;
+static const size_t STATE_HEADER_SIZE = 7;
+static const uint8_t STATE_SHOT_PENDING = 1;
+static const uint8_t STATE_IDLE_SAMPLING = 2;
+
+size_t VL53L1XZoneMonitorBase::saveZoneState(uint8_t *buffer, size_t buffer_size) const
+{
+    StateLock lock(*this);
+    ConfigWriter writer = {buffer, buffer_size, 0};
+    writer.put16(STATE_MAGIC);
+    writer.put8(STATE_VERSION);
+#if VL53L1XZONEMONITOR_ENABLE_SINGLE_SHOT
+    writer.put8((shot_pending ? STATE_SHOT_PENDING : 0) | (idle_sampling ? STATE_IDLE_SAMPLING : 0));
+#else
+    writer.put8(idle_sampling ? STATE_IDLE_SAMPLING : 0);
+#endif
+    writer.put16((uint16_t)zone_slots);
+#if VL53L1XZONEMONITOR_MAX_COUNTERS > 0
+    writer.put8(counter_count);
+#else
+    writer.put8(0);
+#endif
+    for (size_t i = 0; i < zone_slots; i++)
+    {
+        writer.put8(zone_in_count[i]);
+        writer.put8(zone_out_count[i]);
+    }
+    for (size_t b = 0; b < (zone_slots + 7) / 8; b++)
+        writer.put8(zone_present[b]);
+#if VL53L1XZONEMONITOR_MAX_COUNTERS > 0
+    for (uint8_t c = 0; c < counter_count; c++)
+    {
+        writer.put8(counters[c].progress);
+        writer.put8((uint8_t)counters[c].direction);
+        writer.put32(counters[c].in_count);
+        writer.put32(counters[c].out_count);
+    }
+#endif
+
+    size_t size = writer.size + 2;
+    if (!buffer)
+        return size;
+    if (size > buffer_size)
+        return 0;
+    writer.put16(configChecksum(buffer, writer.size));
+    return size;
 }
 
-void VL53L1XZoneMonitor::update()
+bool VL53L1XZoneMonitorBase::restoreZoneState(const uint8_t *data, size_t size)
 {
-    performUpdate();
+    if (!data || size < STATE_HEADER_SIZE + 2)
+        return false;
+    uint16_t crc = (uint16_t)(data[size - 2] | (uint16_t)data[size - 1] << 8);
+    if (configChecksum(data, size - 2) != crc)
+        return false;
+    ConfigReader reader = {data, size - 2, 0, true};
+    if (reader.get16() != STATE_MAGIC || reader.get8() != STATE_VERSION)
+        return false;
+    uint8_t flags = reader.get8();
+    size_t slots = reader.get16();
+    uint8_t count = reader.get8();
+
+    StateLock lock(*this);
+#if VL53L1XZONEMONITOR_MAX_COUNTERS > 0
+    if (count != counter_count)
+        return false;
+#else
+    if (count != 0)
+        return false;
+#endif
+    if (slots != zone_slots ||
+        size != STATE_HEADER_SIZE + 2 * slots + (slots + 7) / 8 + 10 * (size_t)count + 2)
+        return false;
+    for (size_t i = 0; i < zone_slots; i++)
+    {
+        zone_in_count[i] = reader.get8();
+        zone_out_count[i] = reader.get8();
+    }
+    for (size_t b = 0; b < (zone_slots + 7) / 8; b++)
+        zone_present[b] = reader.get8();
+    for (size_t i = 0; i < zone_slots; i++)
+    {
+        if (isZoneSlotUsed(i))
+            continue;
+        zone_in_count[i] = 0;
+        zone_out_count[i] = 0;
+        clearBit(zone_present, i);
+    }
+#if VL53L1XZONEMONITOR_MAX_COUNTERS > 0
+    for (uint8_t c = 0; c < counter_count; c++)
+    {
+        PassageCounter &counter = counters[c];
+        counter.progress = reader.get8();
+        counter.direction = (int8_t)reader.get8();
+        counter.in_count = reader.get32();
+        counter.out_count = reader.get32();
+        counter.occupied = 0;
+        for (uint8_t p = 0; p < counter.zone_count; p++)
+        {
+            if (testBit(zone_present, counter.zones[p]))
+                counter.occupied |= 1 << p;
+        }
+        if (counter.zone_count == 0 || counter.progress > counter.zone_count)
+        {
+            counter.progress = 0;
+            counter.direction = 0;
+        }
+        // Timestamps do not survive sleep; the passage timeout restarts.
+        counter.last_time = currentTime();
+    }
+#endif
+    std::fill(zone_approaching, zone_approaching + (zone_slots + 7) / 8, 0);
+    index_dirty = true;
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+    resyncZoneGroups();
+#endif
+
+    // The sensor kept the idle profile while the MCU slept.
+    if ((flags & STATE_IDLE_SAMPLING) && idle_interval_ms != 0 && !idle_sampling)
+    {
+        idle_sampling = true;
+        current_interval_ms = idle_interval_ms;
+        timing_budget_us = idle_budget_us;
+    }
+    uint32_t now = millis();
+    last_activity_time = currentTime();
+    last_read_time = now;
+#if VL53L1XZONEMONITOR_ENABLE_SINGLE_SHOT
+    next_shot_time = now;
+    shot_pending = single_shot && ranging && (flags & STATE_SHOT_PENDING);
+    if (shot_pending)
+    {
+        // Its result is due; the GPIO1 edge that woke the MCU has passed, but the line stays low.
+        uint32_t result_ms = timing_budget_us / 1000 + SHOT_MARGIN_MS;
+        shot_time = now - result_ms;
+        next_shot_time = shot_time + current_interval_ms;
+        last_update_time = now - result_ms;
+        data_ready_flag = interrupt_pin != NO_INTERRUPT_PIN && digitalRead(interrupt_pin) == LOW;
+    }
+#endif
+    return true;
+}
+
+bool VL53L1XZoneMonitorBase::ensureDriverInitialized()
+{
+    if (driver_initialized)
+        return true;
+#if VL53L1XZONEMONITOR_ENABLE_FAULT_RECOVERY
+    // While recovering, the sensor is only initialized once it answers again.
+    if (health == Recovering && recovery_phase != RecoverInit)
+        return false;
+#endif
+    BusGuard bus(*this, VL53L1XBusLock::WAIT_FOREVER);
+    if (!sensor.init())
+        return false;
+    driver_initialized = true;
+    sensor.setDistanceMode((VL53L1X::DistanceMode)restored_distance_mode);
+    sensor.setMeasurementTimingBudget(timing_budget_us);
+    if (roi_count > 0)
+    {
+        sensor.setROISize(rois[roi_position].width, rois[roi_position].height);
+        sensor.setROICenter(rois[roi_position].center);
+    }
+    if (!single_shot)
+        sensor.startContinuous(current_interval_ms);
+    resetReadState();
+    return true;
+}
+
+size_t VL53L1XZoneMonitorBase::addZone(uint16_t min, uint16_t max, ZoneEnterCallback onEnter, ZoneExitCallback onExit)
+{
+    StateLock lock(*this);
+    size_t zone_index = allocateZoneSlot();
+    if (zone_index == INVALID_ZONE)
+        return INVALID_ZONE;
+    zone_min[zone_index] = min;
+    zone_max[zone_index] = max;
+    zone_in_count[zone_index] = 0;
+    zone_out_count[zone_index] = 0;
+    zone_hysteresis[zone_index] = 0;
+    zone_certainty[zone_index] = 0;
+    zone_roi[zone_index] = 0;
+    clearBit(zone_present, zone_index);
+    clearBit(zone_approaching, zone_index);
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+    zone_groups[zone_index] = 0;
+#endif
+    zone_generation[zone_index] = next_generation++;
+    zone_callbacks[zone_index].on_enter = onEnter;
+    zone_callbacks[zone_index].on_exit = onExit;
+#if VL53L1XZONEMONITOR_ENABLE_MOTION
+    zone_callbacks[zone_index].on_approach = nullptr;
+#endif
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+    zone_callback_us[zone_index] = VL53L1XTimingStats();
+#endif
+    index_dirty = true;
+    return zone_index;
+}
+
+size_t VL53L1XZoneMonitorBase::addZone(uint16_t min, uint16_t max, void (*onEnter)(void *, uint16_t), void (*onExit)(void *),
+                                       void *context)
+{
+    return addZone(min, max, ZoneEnterCallback(onEnter, context), ZoneExitCallback(onExit, context));
+}
+
+bool VL53L1XZoneMonitorBase::isZoneSlotUsed(size_t zone_index) const
+{
+    return zone_index < zone_slots && (!zone_used || testBit(zone_used, zone_index));
+}
+
+bool VL53L1XZoneMonitorBase::isObjectInZone(size_t zone_index, uint32_t *age_ms) const
+{
+    if (age_ms)
+    {
+        *age_ms = last_sample.sequence ? currentTime() - last_sample.timestamp : UINT32_MAX;
+    }
+    if (isZoneSlotUsed(zone_index))
+    {
+        return testBit(zone_present, zone_index);
+    }
+    return false;
+}
+
+uint32_t VL53L1XZoneMonitorBase::getOccupancyMask(size_t first_zone) const
+{
+    uint32_t mask = 0;
+    for (size_t bit = 0; bit < 32 && first_zone + bit < zone_slots; bit++)
+    {
+        if (testBit(zone_present, first_zone + bit))
+            mask |= (uint32_t)1 << bit;
+    }
+    return mask;
+}
+
+size_t VL53L1XZoneMonitorBase::getOccupancyMask(uint8_t *mask, size_t mask_bytes) const
+{
+    size_t bytes = std::min(mask_bytes, (zone_slots + 7) / 8);
+    std::copy(zone_present, zone_present + bytes, mask);
+    if (bytes > 0 && bytes * 8 > zone_slots)
+    {
+        mask[bytes - 1] &= (uint8_t)((1 << (zone_slots & 7)) - 1);
+    }
+    return bytes;
+}
+
+size_t VL53L1XZoneMonitorBase::getZoneCount() const
+{
+    return zone_slots;
+}
+
+ZoneView VL53L1XZoneMonitorBase::getZone(size_t zone_index) const
+{
+    if (isZoneSlotUsed(zone_index))
+    {
+        return ZoneView(this, zone_index);
+    }
+    return ZoneView();
+}
+
+void VL53L1XZoneMonitorBase::setZoneCallbacks(size_t zone_index, ZoneEnterCallback onEnter, ZoneExitCallback onExit)
+{
+    StateLock lock(*this);
+    if (isZoneSlotUsed(zone_index))
+    {
+        zone_callbacks[zone_index].on_enter = onEnter;
+        zone_callbacks[zone_index].on_exit = onExit;
+    }
+}
+
+#if VL53L1XZONEMONITOR_ENABLE_MOTION
+bool VL53L1XZoneMonitorBase::setZoneApproachCallback(size_t zone_index, ZoneApproachCallback onApproach)
+{
+    StateLock lock(*this);
+    if (!isZoneSlotUsed(zone_index))
+        return false;
+    zone_callbacks[zone_index].on_approach = onApproach;
+    return true;
+}
+#endif
+
+void VL53L1XZoneMonitorBase::updateZone(size_t zone_index, uint16_t min_distance, uint16_t max_distance)
+{
+    StateLock lock(*this);
+    if (isZoneSlotUsed(zone_index))
+    {
+        if (min_distance != 0)
+        {
+            zone_min[zone_index] = min_distance;
+        }
+
+        if (max_distance != 0)
+        {
+            zone_max[zone_index] = max_distance;
+        }
+        index_dirty = true;
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+        for (uint8_t g = 0; g < group_count; g++)
+        {
+            if ((zone_groups[zone_index] >> g) & 1)
+                refreshZoneGroup(g);
+        }
+#endif
+    }
+}
+
+bool VL53L1XZoneMonitorBase::setZoneBounds(size_t zone_index, uint16_t min_distance, uint16_t max_distance)
+{
+    StateLock lock(*this);
+    if (!isZoneSlotUsed(zone_index))
+        return false;
+    zone_min[zone_index] = min_distance;
+    zone_max[zone_index] = max_distance;
+    index_dirty = true;
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+    for (uint8_t g = 0; g < group_count; g++)
+    {
+        if ((zone_groups[zone_index] >> g) & 1)
+            refreshZoneGroup(g);
+    }
+#endif
+    return true;
+}
+
+void VL53L1XZoneMonitorBase::beginConfig()
+{
+#if defined(ESP32)
+    if (config_depth == 0 && state_mutex)
+    {
+        xSemaphoreTakeRecursive(state_mutex, portMAX_DELAY);
+        config_mutex = state_mutex;
+    }
+#endif
+    config_depth++;
+}
+
+bool VL53L1XZoneMonitorBase::commit()
+{
+    if (config_depth == 0)
+        return false;
+    if (--config_depth == 0)
+    {
+        if (index_dirty)
+            rebuildZoneIndex();
+#if defined(ESP32)
+        if (config_mutex)
+        {
+            config_mutex = nullptr;
+            xSemaphoreGiveRecursive(state_mutex);
+        }
+#endif
+    }
+    return true;
+}
+
+bool VL53L1XZoneMonitorBase::isConfiguring() const
+{
+    return config_depth > 0;
+}
+
+bool VL53L1XZoneMonitorBase::setZoneHysteresis(size_t zone_index, uint16_t hysteresis)
+{
+    StateLock lock(*this);
+    if (!isZoneSlotUsed(zone_index))
+        return false;
+    // Present zones are always evaluated, so the index needs no rebuild.
+    zone_hysteresis[zone_index] = hysteresis;
+    return true;
+}
+
+bool VL53L1XZoneMonitorBase::setZoneCertainty(size_t zone_index, uint8_t certainty)
+{
+    StateLock lock(*this);
+    if (!isZoneSlotUsed(zone_index))
+        return false;
+    zone_certainty[zone_index] = certainty;
+    return true;
+}
+
+bool VL53L1XZoneMonitorBase::setZoneRoi(size_t zone_index, uint8_t roi)
+{
+    StateLock lock(*this);
+    if (!isZoneSlotUsed(zone_index) || roi >= MAX_ROIS)
+        return false;
+    zone_roi[zone_index] = roi;
+    return true;
+}
+
+bool VL53L1XZoneMonitorBase::setRoiScan(const VL53L1XRoi *roi_list, uint8_t count)
+{
+    if (count > MAX_ROIS)
+        return false;
+    for (uint8_t r = 0; r < count; r++)
+    {
+        if (roi_list[r].width < 4 || roi_list[r].width > 16 || roi_list[r].height < 4 || roi_list[r].height > 16)
+            return false;
+    }
+
+    StateLock lock(*this);
+    BusGuard bus(*this, VL53L1XBusLock::WAIT_FOREVER);
+    for (uint8_t r = 0; r < count; r++)
+        rois[r] = roi_list[r];
+    roi_count = count;
+    roi_position = 0;
+    settling = sample_source == nullptr;
+    for (uint8_t r = 0; r < MAX_ROIS; r++)
+    {
+#if VL53L1XZONEMONITOR_ENABLE_PREFILTER
+        prefilters[r].reset();
+#endif
+#if VL53L1XZONEMONITOR_ENABLE_BACKGROUND
+        backgrounds[r].reset();
+#endif
+    }
+    if (count > 0)
+    {
+        sensor.setROISize(rois[0].width, rois[0].height);
+        sensor.setROICenter(rois[0].center);
+    }
+    else
+    {
+        sensor.setROISize(16, 16);
+        sensor.setROICenter(199);
+    }
+    return true;
+}
+
+uint8_t VL53L1XZoneMonitorBase::getRoiCount() const
+{
+    return roi_count;
+}
+
+uint8_t VL53L1XZoneMonitorBase::advanceRoiScan()
+{
+    if (roi_count < 2)
+        return 0;
+    uint8_t current = roi_position;
+    roi_position = roi_position + 1 == roi_count ? 0 : roi_position + 1;
+    if (!sample_source)
+    {
+        sensor.setROISize(rois[roi_position].width, rois[roi_position].height);
+        sensor.setROICenter(rois[roi_position].center);
+    }
+    return current;
+}
+
+void VL53L1XZoneMonitorBase::deleteZone(size_t zone_index)
+{
+    StateLock lock(*this);
+    if (isZoneSlotUsed(zone_index))
+    {
+        clearBit(zone_present, zone_index);
+        clearBit(zone_approaching, zone_index);
+        // Queued events name their zone by index, so indices stay put while a queue is attached.
+        bool shifted = releaseZoneSlot(zone_index, config_depth > 0 || event_queue);
+        index_dirty = true;
+        zones_moved |= shifted;
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+        if (stats.slowest_callback_zone == zone_index)
+            stats.slowest_callback_zone = SIZE_MAX;
+        else if (shifted && stats.slowest_callback_zone != SIZE_MAX && stats.slowest_callback_zone > zone_index)
+            stats.slowest_callback_zone--;
+#endif
+#if VL53L1XZONEMONITOR_MAX_COUNTERS > 0
+        if (counter_count > 0)
+            releasePassageZone(zone_index, shifted);
+#endif
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+        if (group_count > 0)
+            resyncZoneGroups();
+#endif
+    }
+}
+
+uint16_t VL53L1XZoneMonitorBase::getDistance() const
+{
+    return last_sample.distance;
+}
+
+const VL53L1XSample &VL53L1XZoneMonitorBase::getLastSample() const
+{
+    return last_sample;
+}
+
+void VL53L1XZoneMonitorBase::setCertaintyFactor(size_t certainty)
+{
+    StateLock lock(*this);
+    certainty_factor = certainty;
+}
+
+size_t VL53L1XZoneMonitorBase::getCertaintyFactor() const
+{
+    return certainty_factor;
+}
+
+bool VL53L1XZoneMonitorBase::performUpdate()
+{
+    if (config_depth > 0)
+        return false;
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+    uint32_t previous_read = last_sample.timestamp;
+#endif
+    if (sample_source)
+    {
+        if (!readMeasurement())
+            return false;
+    }
+    else
+    {
+        bool measured = readSensorSample();
+#if VL53L1XZONEMONITOR_ENABLE_FAULT_RECOVERY
+        // Reported with the bus released, so callbacks may use it.
+        reportFaultState();
+#endif
+        if (!measured)
+            return false;
+    }
+    last_sample.sequence++;
+    last_sample.confidence = measureConfidence(sample_source == nullptr);
+    if (last_sample.confidence < min_confidence)
+        last_sample.valid = false;
+#if VL53L1XZONEMONITOR_ENABLE_SAMPLE_LOG
+    if (sample_log)
+    {
+        float signal_rate = sample_source ? 0 : sensor.ranging_data.peak_signal_count_rate_MCPS;
+        sample_log->push(VL53L1XLogEntry::make(last_sample.timestamp, last_sample.raw_distance,
+                                               last_sample.range_status, signal_rate));
+    }
+#endif
+    if (settling)
+    {
+        // Measured with the settings or region of interest in place before the last change.
+        settling = false;
+        last_sample.valid = false;
+    }
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+    uint32_t read_done_us = micros();
+    stats.reads++;
+    // The sensor overwrites unread results, so a gap of several periods
+    // between reads means the measurements in between were lost.
+    uint32_t gap_ms = last_sample.timestamp - previous_read;
+    if (last_sample.sequence > 1 && current_interval_ms > 0 && gap_ms >= 2 * current_interval_ms)
+        stats.missed_samples += gap_ms / current_interval_ms - 1;
+#endif
+    // A rejected measurement carries no information, so the zones keep
+    // their state and adaptive sampling sees the current occupancy.
+    bool activity;
+    if (last_sample.valid)
+    {
+#if VL53L1XZONEMONITOR_ENABLE_PREFILTER
+        last_sample.distance = prefilters[last_sample.roi].apply(last_sample.raw_distance);
+#else
+        last_sample.distance = last_sample.raw_distance;
+#endif
+#if VL53L1XZONEMONITOR_ENABLE_MOTION
+        if (motion_tracking)
+        {
+            // A region is measured once per scan; a few missed scans keep the estimate.
+            uint32_t scan_ms = current_interval_ms * (roi_count > 0 ? roi_count : 1);
+            uint32_t max_gap = scan_ms * TRACKER_GAP_SCANS;
+            if (max_gap < VL53L1XMotionTracker::MAX_GAP_MS)
+                max_gap = VL53L1XMotionTracker::MAX_GAP_MS;
+            trackers[last_sample.roi].update(last_sample.distance, last_sample.timestamp, max_gap);
+            last_sample.velocity = trackers[last_sample.roi].getVelocity();
+        }
+#endif
+#if VL53L1XZONEMONITOR_ENABLE_BACKGROUND
+        last_sample.background =
+            background_suppression && backgrounds[last_sample.roi].update(last_sample.distance, last_sample.timestamp);
+        if (last_sample.background)
+        {
+            activity = evaluateBackground(last_sample.distance, last_sample.roi);
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+            stats.background_samples++;
+#endif
+        }
+        else
+#endif
+        {
+            activity = evaluateZones(last_sample.distance, last_sample.roi);
+#if VL53L1XZONEMONITOR_ENABLE_MOTION
+            if (approach_lead_ms > 0 && !zones_moved)
+                predictZoneEntries(last_sample.distance, last_sample.roi);
+#endif
+        }
+    }
+    else
+    {
+        last_sample.background = false;
+        last_sample.distance = last_sample.raw_distance;
+        activity = active_count > 0;
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+        stats.rejected_samples++;
+#endif
+    }
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+    if (group_changes)
+        reportZoneGroups();
+#endif
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+    stats.evaluation_us.record(micros() - read_done_us);
+#endif
+    updateSamplingProfile(activity, last_sample.timestamp);
+    return true;
+}
+
+bool VL53L1XZoneMonitorBase::readSensorSample()
+{
+    // Held only for the sensor access; reports and evaluation run after it is released.
+    BusGuard bus(*this, bus_wait_ms);
+    if (!bus.isHeld())
+    {
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+        stats.bus_busy++;
+#endif
+        return false;
+    }
+#if VL53L1XZONEMONITOR_ENABLE_FAULT_RECOVERY
+    if (health == Recovering)
+    {
+        stepRecovery(millis());
+        return false;
+    }
+    sensor.last_status = 0;
+    if (!readMeasurement())
+    {
+        if (fault_recovery)
+        {
+            uint32_t now = millis();
+            if (sensor.last_status != 0)
+            {
+                recordSensorResult(true, now);
+            }
+            else if (ranging && pending_read.phase == ReadIdle && now - last_read_time > STALL_INTERVALS * current_interval_ms)
+            {
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+                stats.sensor_faults++;
+#endif
+                startRecovery(now);
+            }
+        }
+        return false;
+    }
+#else
+    if (!readMeasurement())
+        return false;
+#endif
+    last_read_time = last_sample.timestamp;
+#if VL53L1XZONEMONITOR_ENABLE_FAULT_RECOVERY
+    if (fault_recovery)
+    {
+        // A sensor that stopped answering reads as all ones, which decodes to no range status.
+        bool faulty = sensor.last_status != 0 || sensor.timeoutOccurred() ||
+                      last_sample.range_status == VL53L1X::HardwareFail || last_sample.range_status == VL53L1X::None;
+        if (faulty)
+            last_sample.valid = false;
+        recordSensorResult(faulty, last_sample.timestamp);
+    }
+#endif
+    return true;
+}
+
+bool VL53L1XZoneMonitorBase::readMeasurement()
+{
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+    uint32_t start_us = micros();
+#endif
+    if (sample_source)
+    {
+        uint16_t distance;
+        uint8_t range_status;
+        if (!sample_source->readSample(distance, range_status))
+        {
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+            stats.not_ready_polls++;
+#endif
+            return false;
+        }
+        last_sample.roi = advanceRoiScan();
+        last_sample.raw_distance = distance;
+        last_sample.range_status = range_status;
+        last_sample.timestamp = sample_source->now();
+        last_sample.valid = passesSampleFilter(false);
+    }
+#if VL53L1XZONEMONITOR_ENABLE_SINGLE_SHOT
+    else if (single_shot && pending_read.phase == ReadIdle && !updateSingleShot())
+    {
+        return false;
+    }
+#endif
+    else if (pending_read.phase != ReadIdle || (async_read && driver_calibrated))
+    {
+        if (pending_read.phase == ReadIdle)
+        {
+            if (!isMeasurementReady())
+                return false;
+            pending_read.phase = ReadStatus;
+            pending_read.roi = 0;
+            pending_read.timestamp = millis();
+            // Polling already used the bus in this call.
+            if (interrupt_pin == NO_INTERRUPT_PIN && bus_budget_us == 0)
+                return false;
+        }
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+        start_us = micros();
+#endif
+        uint32_t budget_start_us = micros();
+        while (!stepAsyncRead())
+        {
+            if (bus_budget_us == 0 || micros() - budget_start_us >= bus_budget_us)
+            {
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+                stats.read_us.record(micros() - start_us);
+#endif
+                return false;
+            }
+        }
+    }
+    else
+    {
+        if (!isMeasurementReady())
+            return false;
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+        start_us = micros();
+#endif
+        last_sample.roi = advanceRoiScan();
+        last_sample.raw_distance = sensor.read(false);
+        last_sample.range_status = sensor.ranging_data.range_status;
+        last_sample.timestamp = millis();
+        last_sample.valid = passesSampleFilter(true);
+        driver_calibrated = true;
+    }
+#if VL53L1XZONEMONITOR_ENABLE_SINGLE_SHOT
+    shot_pending = false;
+#endif
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+    stats.read_us.record(micros() - start_us);
+#endif
+    return true;
+}
+
+#if VL53L1XZONEMONITOR_ENABLE_SINGLE_SHOT
+bool VL53L1XZoneMonitorBase::updateSingleShot()
+{
+    uint32_t now = millis();
+    uint32_t result_ms = timing_budget_us / 1000 + SHOT_MARGIN_MS;
+    if (shot_pending)
+    {
+        if (now - shot_time < result_ms + current_interval_ms)
+            return true;
+    }
+    else if (!ranging || (int32_t)(now - next_shot_time) < 0)
+    {
+        return false;
+    }
+    // The driver's non-blocking readSingle() only clears the interrupt and starts the measurement.
+    sensor.readSingle(false);
+    shot_pending = true;
+    shot_time = now;
+    next_shot_time = now + current_interval_ms;
+    last_update_time = now;
+    data_ready_flag = false;
+    return false;
+}
+#endif
+
+bool VL53L1XZoneMonitorBase::isMeasurementReady()
+{
+    if (interrupt_pin != NO_INTERRUPT_PIN)
+    {
+        // The flag is cleared before reading so that a measurement completing
+        // during the read is never lost; at worst it is read twice.
+        if (!data_ready_flag)
+            return false;
+        data_ready_flag = false;
+        return true;
+    }
+
+    // A single measurement is polled once its result is expected.
+    uint32_t poll_ms = single_shot ? timing_budget_us / 1000 + SHOT_MARGIN_MS : current_interval_ms;
+    if (millis() - last_update_time < poll_ms)
+        return false;
+    last_update_time = millis();
+    if (!sensor.dataReady())
+    {
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+        stats.not_ready_polls++;
+#endif
+        return false;
+    }
+    return true;
+}
+
+// Converts the device status as the driver's getRangingData() does.
+static uint8_t convertRangeStatus(uint8_t device_status, uint8_t stream_count)
+{
+    switch (device_status & 0x1F)
+    {
+    case 1:  // VCSELCONTINUITYTESTFAILURE
+    case 2:  // VCSELWATCHDOGTESTFAILURE
+    case 3:  // NOVHVVALUEFOUND
+    case 17: // MULTCLIPFAIL
+        return VL53L1X::HardwareFail;
+    case 13: // USERROICLIP
+        return VL53L1X::MinRangeFail;
+    case 18: // GPHSTREAMCOUNT0READY
+        return VL53L1X::SynchronizationInt;
+    case 5: // RANGEPHASECHECK
+        return VL53L1X::OutOfBoundsFail;
+    case 4: // MSRCNOTARGET
+        return VL53L1X::SignalFail;
+    case 6: // SIGMATHRESHOLDCHECK
+        return VL53L1X::SigmaFail;
+    case 7: // PHASECONSISTENCY
+        return VL53L1X::WrapTargetFail;
+    case 12: // RANGEIGNORETHRESHOLD
+        return VL53L1X::XtalkSignalFail;
+    case 8: // MINCLIP
+        return VL53L1X::RangeValidMinRangeClipped;
+    case 9: // RANGECOMPLETE
+        return stream_count == 0 ? VL53L1X::RangeValidNoWrapCheckFail : VL53L1X::RangeValid;
+    default:
+        return VL53L1X::None;
+    }
+}
+
+// Computes the SPAD target for the next measurement as the driver's updateDSS() does.
+static uint16_t requiredSpads(uint16_t spads, uint16_t peak_rate, uint16_t ambient_rate)
+{
+    const uint32_t target_rate = 0x0A00;
+    if (spads != 0)
+    {
+        uint32_t total_rate_per_spad = (uint32_t)peak_rate + ambient_rate;
+        if (total_rate_per_spad > 0xFFFF)
+            total_rate_per_spad = 0xFFFF;
+        total_rate_per_spad = (total_rate_per_spad << 16) / spads;
+        if (total_rate_per_spad != 0)
+        {
+            uint32_t required = (target_rate << 16) / total_rate_per_spad;
+            return required > 0xFFFF ? 0xFFFF : required;
+        }
+    }
+    return 0x8000;
+}
+
+bool VL53L1XZoneMonitorBase::stepAsyncRead()
+{
+    switch (pending_read.phase)
+    {
+    case ReadStatus:
+    {
+        // RESULT__RANGE_STATUS, RESULT__REPORT_STATUS, RESULT__STREAM_COUNT and one more byte.
+        uint32_t head = sensor.readReg32Bit(VL53L1X::RESULT__RANGE_STATUS);
+        pending_read.range_status = head >> 24;
+        pending_read.stream_count = head >> 8;
+        pending_read.phase = ReadSpads;
+        return false;
+    }
+    case ReadSpads:
+        pending_read.spads = sensor.readReg16Bit(VL53L1X::RESULT__DSS_ACTUAL_EFFECTIVE_SPADS_SD0);
+        pending_read.phase = ReadAmbient;
+        return false;
+    case ReadAmbient:
+        pending_read.ambient_rate = sensor.readReg16Bit(VL53L1X::RESULT__AMBIENT_COUNT_RATE_MCPS_SD0);
+        pending_read.phase = ReadRange;
+        return false;
+    case ReadRange:
+    {
+        // The peak signal rate directly follows the range.
+        uint32_t range_and_rate = sensor.readReg32Bit(VL53L1X::RESULT__FINAL_CROSSTALK_CORRECTED_RANGE_MM_SD0);
+        pending_read.range = range_and_rate >> 16;
+        pending_read.peak_rate = range_and_rate;
+        pending_read.phase = WriteDss;
+        return false;
+    }
+    case WriteDss:
+        sensor.writeReg16Bit(VL53L1X::DSS_CONFIG__MANUAL_EFFECTIVE_SPADS_SELECT,
+                             requiredSpads(pending_read.spads, pending_read.peak_rate, pending_read.ambient_rate));
+        pending_read.phase = roi_count > 1 ? ProgramRoi : ClearInterrupt;
+        return false;
+    case ProgramRoi:
+        pending_read.roi = advanceRoiScan();
+        pending_read.phase = ClearInterrupt;
+        return false;
+    case ClearInterrupt:
+    default:
+        sensor.writeReg(VL53L1X::SYSTEM__INTERRUPT_CLEAR, 0x01);
+        pending_read.phase = ReadIdle;
+        break;
+    }
+
+    // Keep the driver's ranging data current, as its own read() would.
+    sensor.ranging_data.range_mm = ((uint32_t)pending_read.range * 2011 + 0x0400) / 0x0800;
+    sensor.ranging_data.range_status = (VL53L1X::RangeStatus)convertRangeStatus(pending_read.range_status, pending_read.stream_count);
+    sensor.ranging_data.peak_signal_count_rate_MCPS = pending_read.peak_rate / 128.0f;
+    sensor.ranging_data.ambient_count_rate_MCPS = pending_read.ambient_rate / 128.0f;
+
+    last_sample.roi = pending_read.roi;
+    last_sample.raw_distance = sensor.ranging_data.range_mm;
+    last_sample.range_status = sensor.ranging_data.range_status;
+    last_sample.timestamp = pending_read.timestamp;
+    last_sample.valid = passesSampleFilter(true);
+    return true;
+}
+
+void VL53L1XZoneMonitorBase::resetReadState()
+{
+    pending_read.phase = ReadIdle;
+    driver_calibrated = false;
+    last_read_time = millis();
+#if VL53L1XZONEMONITOR_ENABLE_SINGLE_SHOT
+    shot_pending = false;
+    next_shot_time = last_read_time;
+#endif
+}
+
+#if VL53L1XZONEMONITOR_ENABLE_FAULT_RECOVERY
+bool VL53L1XZoneMonitorBase::enableFaultRecovery(uint8_t xshut_pin, uint8_t faults, uint32_t backoff_ms)
+{
+    if (faults == 0)
+        return false;
+    StateLock lock(*this);
+    shutdown_pin = xshut_pin;
+    max_faults = faults;
+    max_backoff_ms = backoff_ms;
+    fault_count = 0;
+    fault_recovery = true;
+    return true;
+}
+
+void VL53L1XZoneMonitorBase::disableFaultRecovery()
+{
+    StateLock lock(*this);
+    fault_recovery = false;
+    fault_count = 0;
+    if (health == Recovering && shutdown_pin != NO_SHUTDOWN_PIN)
+        pinMode(shutdown_pin, INPUT); // Never leave the sensor held in reset.
+    unknown_zones_pending = false;
+    setHealth(Healthy);
+    reportFaultState();
+}
+#endif
+
+VL53L1XZoneMonitorBase::Health VL53L1XZoneMonitorBase::getHealth() const
+{
+#if VL53L1XZONEMONITOR_ENABLE_FAULT_RECOVERY
+    return health;
+#else
+    return Healthy;
+#endif
+}
+
+#if VL53L1XZONEMONITOR_ENABLE_FAULT_RECOVERY
+void VL53L1XZoneMonitorBase::setUnknownZonePolicy(UnknownZonePolicy policy)
+{
+    StateLock lock(*this);
+    unknown_policy = policy;
+}
+
+void VL53L1XZoneMonitorBase::setHealthCallback(HealthCallback onHealthChange)
+{
+    StateLock lock(*this);
+    on_health_change = onHealthChange;
+}
+
+void VL53L1XZoneMonitorBase::recordSensorResult(bool faulty, uint32_t now)
+{
+    if (!faulty)
+    {
+        fault_count = 0;
+        if (health == Degraded)
+            setHealth(Healthy);
+        return;
+    }
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+    stats.sensor_faults++;
+#endif
+    if (fault_count < UINT8_MAX)
+        fault_count++;
+    if (fault_count >= max_faults)
+        startRecovery(now);
+    else
+        setHealth(Degraded);
+}
+
+void VL53L1XZoneMonitorBase::startRecovery(uint32_t now)
+{
+    // The driver caches the distance mode, so it survives a dead sensor.
+    if (driver_initialized)
+        restored_distance_mode = sensor.getDistanceMode();
+    driver_initialized = false;
+    recovery_address = sensor.getAddress();
+    recovery_phase = RecoverWait;
+    recovery_time = now;
+    recovery_delay_ms = 0;
+    pending_read.phase = ReadIdle;
+    data_ready_flag = false;
+    setHealth(Recovering);
+
+    // Pending counts stem from measurements before the fault and are dropped.
+    for (size_t i = 0; i < zone_slots; i++)
+    {
+        zone_in_count[i] = 0;
+        zone_out_count[i] = 0;
+    }
+    std::fill(zone_approaching, zone_approaching + (zone_slots + 7) / 8, 0);
+#if VL53L1XZONEMONITOR_MAX_COUNTERS > 0
+    abandonPassages();
+#endif
+    unknown_zones_pending = true;
+    index_dirty = true;
+}
+
+void VL53L1XZoneMonitorBase::reportFaultState()
+{
+    if (health != reported_health)
+    {
+        reported_health = health;
+        HealthCallback on_change = on_health_change;
+        if (on_change)
+            on_change(health);
+    }
+    if (!unknown_zones_pending)
+        return;
+    unknown_zones_pending = false;
+    for (size_t i = 0; i < zone_slots; i++)
+    {
+        if (!isZoneSlotUsed(i))
+            continue;
+        bool present = testBit(zone_present, i);
+        if (unknown_policy == ReportEmpty && present)
+        {
+            clearBit(zone_present, i);
+            emitZoneEvent(i, ZoneEvent::Exit, 0, 0, false);
+        }
+        else if (unknown_policy == ReportOccupied && !present)
+        {
+            setBit(zone_present, i);
+            emitZoneEvent(i, ZoneEvent::Enter, 0, 0, false);
+        }
+    }
+    index_dirty = true;
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+    if (group_changes)
+        reportZoneGroups();
+#endif
+}
+
+void VL53L1XZoneMonitorBase::stepRecovery(uint32_t now)
+{
+    switch (recovery_phase)
+    {
+    case RecoverWait:
+        if (now - recovery_time < recovery_delay_ms)
+            return;
+        if (shutdown_pin != NO_SHUTDOWN_PIN)
+        {
+            pinMode(shutdown_pin, OUTPUT);
+            digitalWrite(shutdown_pin, LOW);
+            // The sensor ignores this write while held in reset; the driver
+            // then talks to the address the sensor boots with.
+            if (sensor.getAddress() != DEFAULT_ADDRESS)
+                sensor.setAddress(DEFAULT_ADDRESS);
+            recovery_phase = RecoverRelease;
+        }
+        else
+        {
+            // The driver's init() performs the software reset.
+            recovery_phase = RecoverProbe;
+        }
+        recovery_time = now;
+        return;
+    case RecoverRelease:
+        if (now - recovery_time < RESET_PULSE_MS)
+            return;
+        // Released to the pull-up, as XSHUT is not level shifted on most carrier boards.
+        pinMode(shutdown_pin, INPUT);
+        recovery_phase = RecoverProbe;
+        recovery_time = now;
+        return;
+    case RecoverProbe:
+        if (sensor.readReg16Bit(VL53L1X::IDENTIFICATION__MODEL_ID) == 0xEACC && sensor.last_status == 0)
+        {
+            if (sensor.getAddress() != recovery_address)
+                sensor.setAddress(recovery_address);
+            recovery_phase = RecoverInit;
+        }
+        else if (now - recovery_time >= BOOT_TIMEOUT_MS)
+        {
+            failRecovery(now);
+        }
+        return;
+    case RecoverInit:
+    default:
+        sensor.last_status = 0;
+        if (!ensureDriverInitialized() || sensor.last_status != 0)
+        {
+            driver_initialized = false;
+            failRecovery(now);
+            return;
+        }
+        if (!ranging && !single_shot)
+            sensor.stopContinuous();
+        for (uint8_t r = 0; r < MAX_ROIS; r++)
+        {
+#if VL53L1XZONEMONITOR_ENABLE_PREFILTER
+            prefilters[r].reset();
+#endif
+#if VL53L1XZONEMONITOR_ENABLE_MOTION
+            trackers[r].reset();
+#endif
+        }
+        fault_count = 0;
+        recovery_delay_ms = 0;
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+        stats.recoveries++;
+#endif
+#if VL53L1XZONEMONITOR_MAX_COUNTERS > 0
+        abandonPassages();
+#endif
+        setHealth(Healthy);
+        return;
+    }
+}
+
+void VL53L1XZoneMonitorBase::failRecovery(uint32_t now)
+{
+    recovery_phase = RecoverWait;
+    recovery_time = now;
+    if (recovery_delay_ms == 0)
+        recovery_delay_ms = MIN_BACKOFF_MS;
+    else
+        recovery_delay_ms *= 2;
+    if (recovery_delay_ms > max_backoff_ms)
+        recovery_delay_ms = max_backoff_ms;
+}
+
+void VL53L1XZoneMonitorBase::setHealth(Health state)
+{
+    health = state;
+}
+#endif
+
+void VL53L1XZoneMonitorBase::setAsyncRead(bool enable)
+{
+    StateLock lock(*this);
+    async_read = enable;
+}
+
+bool VL53L1XZoneMonitorBase::isAsyncRead() const
+{
+    return async_read;
+}
+
+void VL53L1XZoneMonitorBase::setBusLock(VL53L1XBusLock *lock, uint32_t wait_ms)
+{
+    StateLock state(*this);
+    bus_lock = lock;
+    bus_wait_ms = wait_ms;
+}
+
+VL53L1XBusLock *VL53L1XZoneMonitorBase::getBusLock() const
+{
+    return bus_lock;
+}
+
+void VL53L1XZoneMonitorBase::setBusBudget(uint32_t budget_us)
+{
+    StateLock lock(*this);
+    bus_budget_us = budget_us;
+}
+
+uint32_t VL53L1XZoneMonitorBase::getBusBudget() const
+{
+    return bus_budget_us;
+}
+
+/**
+ * @brief Orders zone indices by their minimum distance, then by index.
+ */
+struct ZoneStartLess
+{
+    const uint16_t *zone_min;
+
+    bool operator()(uint16_t a, uint16_t b) const
+    {
+        return zone_min[a] < zone_min[b] || (zone_min[a] == zone_min[b] && a < b);
+    }
+};
+
+void VL53L1XZoneMonitorBase::rebuildZoneIndex()
+{
+    index_dirty = false;
+    index_valid = false;
+    index_bound_count = 0;
+
+    // candidate_zones is free between samples; it holds the zones in order of their start.
+    size_t live_zones = 0;
+    size_t start_count = 0;
+    active_count = 0;
+    for (size_t i = 0; i < zone_slots; i++)
+    {
+        if (!isZoneSlotUsed(i))
+            continue;
+        live_zones++;
+        if (isZoneActive(i))
+            active_zones[active_count++] = i;
+        if (zone_min[i] <= zone_max[i])
+            candidate_zones[start_count++] = i;
+    }
+    ZoneStartLess start_less = {zone_min};
+    std::sort(candidate_zones, candidate_zones + start_count, start_less);
+
+    // Sweep the boundaries upwards. Each segment is the previous one without
+    // the zones ending at its start and merged with the zones starting there,
+    // so both stay sorted by index and every member is written once.
+    size_t member_capacity = 2 * live_zones;
+    if (!reserveZoneIndex(2 * live_zones, member_capacity))
+        return;
+    size_t member_count = 0;
+    size_t previous = 0;
+    size_t next_start = 0;
+    uint32_t next_end = UINT32_MAX;
+    while (next_start < start_count || next_end != UINT32_MAX)
+    {
+        uint32_t bound = next_end;
+        if (next_start < start_count && zone_min[candidate_zones[next_start]] < bound)
+            bound = zone_min[candidate_zones[next_start]];
+        size_t starting = next_start;
+        while (starting < start_count && zone_min[candidate_zones[starting]] == bound)
+            starting++;
+
+        size_t previous_end = member_count;
+        size_t needed = member_count + (previous_end - previous) + (starting - next_start);
+        if (needed > member_capacity)
+        {
+            member_capacity = needed;
+            if (!reserveZoneIndex(2 * live_zones, member_capacity))
+                return;
+        }
+        index_bounds[index_bound_count] = (uint16_t)bound;
+        index_offsets[index_bound_count++] = member_count;
+        next_end = UINT32_MAX;
+        size_t kept = previous;
+        while (kept < previous_end || next_start < starting)
+        {
+            uint16_t zone;
+            if (next_start == starting || (kept < previous_end && index_members[kept] < candidate_zones[next_start]))
+            {
+                zone = index_members[kept++];
+                if ((uint32_t)zone_max[zone] + 1 == bound)
+                    continue;
+            }
+            else
+            {
+                zone = candidate_zones[next_start++];
+            }
+            index_members[member_count++] = zone;
+            if (zone_max[zone] != UINT16_MAX && (uint32_t)zone_max[zone] + 1 < next_end)
+                next_end = (uint32_t)zone_max[zone] + 1;
+        }
+        previous = previous_end;
+    }
+    index_offsets[index_bound_count] = member_count;
+    index_valid = true;
+}
+
+bool VL53L1XZoneMonitorBase::evaluateZones(uint16_t distance, uint8_t roi)
+{
+    if (index_dirty)
+        rebuildZoneIndex();
+    zones_moved = false;
+
+    uint8_t certainty = certainty_factor < UINT8_MAX ? certainty_factor : UINT8_MAX;
+
+    if (!index_valid)
+    {
+        active_count = 0;
+        for (size_t i = 0; i < zone_slots; i++)
+        {
+            if (!isZoneSlotUsed(i))
+                continue;
+            if (zone_roi[i] == roi)
+                evaluateZone(i, distance, certainty);
+            if (zones_moved)
+                return true; // A callback deleted a zone and moved the later ones.
+            if (isZoneActive(i))
+                active_zones[active_count++] = i;
+        }
+        return active_count > 0;
+    }
+
+    size_t candidate_count;
+    uint16_t *segment = std::upper_bound(index_bounds, index_bounds + index_bound_count, distance);
+    if (segment != index_bounds)
+    {
+        size_t s = (segment - index_bounds) - 1;
+        candidate_count = std::set_union(index_members + index_offsets[s], index_members + index_offsets[s + 1],
+                                         active_zones, active_zones + active_count, candidate_zones) - candidate_zones;
+    }
+    else
+    {
+        candidate_count = std::copy(active_zones, active_zones + active_count, candidate_zones) - candidate_zones;
+    }
+
+    active_count = 0;
+    for (size_t c = 0; c < candidate_count; c++)
+    {
+        uint16_t i = candidate_zones[c];
+        // A callback may have deleted a later candidate.
+        if (!isZoneSlotUsed(i))
+            continue;
+        // Zones of other regions keep their state, including their place in active_zones.
+        if (zone_roi[i] == roi)
+            evaluateZone(i, distance, certainty);
+        // Other zone changes by a callback take effect when the index is rebuilt on the next sample.
+        if (zones_moved)
+            return true; // A callback deleted a zone and moved the later ones.
+        if (isZoneActive(i))
+            active_zones[active_count++] = i;
+    }
+    return active_count > 0;
+}
+
+#if VL53L1XZONEMONITOR_ENABLE_BACKGROUND
+bool VL53L1XZoneMonitorBase::evaluateBackground(uint16_t distance, uint8_t roi)
+{
+    if (index_dirty)
+        rebuildZoneIndex();
+    zones_moved = false;
+
+    uint8_t certainty = certainty_factor < UINT8_MAX ? certainty_factor : UINT8_MAX;
+    // Inactive zones already count as empty, so only active ones can change.
+    size_t candidate_count = std::copy(active_zones, active_zones + active_count, candidate_zones) - candidate_zones;
+    active_count = 0;
+    for (size_t c = 0; c < candidate_count; c++)
+    {
+        uint16_t i = candidate_zones[c];
+        if (!isZoneSlotUsed(i))
+            continue;
+        if (zone_roi[i] == roi)
+            countZoneSample(i, false, distance, certainty);
+        if (zones_moved)
+            return true; // A callback deleted a zone and moved the later ones.
+        if (isZoneActive(i))
+            active_zones[active_count++] = i;
+    }
+    return active_count > 0;
+}
+#endif
+
+bool VL53L1XZoneMonitorBase::fitsInterval(uint32_t budget_us, uint32_t interval_ms)
+{
+    // Compared in microseconds, widened so long periods cannot overflow.
+    return interval_ms != 0 && budget_us <= (uint64_t)interval_ms * 1000;
+}
+
+bool VL53L1XZoneMonitorBase::applySamplingProfile(VL53L1X::DistanceMode mode, uint32_t interval_ms, uint32_t budget_us)
+{
+    BusGuard bus(*this, VL53L1XBusLock::WAIT_FOREVER);
+    if (!ensureDriverInitialized())
+    {
+        // Applied when the driver is initialized.
+        restored_distance_mode = mode;
+        timing_budget_us = budget_us;
+        current_interval_ms = interval_ms;
+        return true;
+    }
+    VL53L1X::DistanceMode previous_mode = sensor.getDistanceMode();
+    sensor.stopContinuous();
+    // setDistanceMode() carries the current budget over to the new mode, so the budget is set last.
+    bool applied = (mode == previous_mode || sensor.setDistanceMode(mode)) && sensor.setMeasurementTimingBudget(budget_us);
+    if (applied)
+    {
+        timing_budget_us = budget_us;
+        current_interval_ms = interval_ms;
+    }
+    else if (sensor.getDistanceMode() != previous_mode)
+    {
+        sensor.setDistanceMode(previous_mode);
+    }
+    if (ranging && !single_shot)
+        sensor.startContinuous(current_interval_ms);
+    resetReadState();
+    data_ready_flag = false;
+    last_update_time = currentTime();
+    // The first result after the restart may still have been measured with
+    // the old settings; a single measurement is only triggered afterwards.
+    settling = ranging && !single_shot && sample_source == nullptr;
+    return applied;
+}
+
+void VL53L1XZoneMonitorBase::updateSamplingProfile(bool activity, uint32_t now)
+{
+    if (idle_interval_ms == 0)
+        return;
+
+    if (activity)
+    {
+        last_activity_time = now;
+        if (idle_sampling)
+        {
+            applySamplingProfile(getDistanceMode(), update_interval_ms, active_budget_us);
+            idle_sampling = false;
+        }
+    }
+    else if (!idle_sampling && now - last_activity_time >= activity_hold_ms)
+    {
+        applySamplingProfile(getDistanceMode(), idle_interval_ms, idle_budget_us);
+        idle_sampling = true;
+    }
+}
+
+void VL53L1XZoneMonitorBase::evaluateZone(size_t i, uint16_t distance, uint8_t certainty)
+{
+    // The hysteresis only widens zones with an object present. Those are
+    // always in active_zones, so the index of the plain bounds stays exact.
+    uint16_t margin = testBit(zone_present, i) ? zone_hysteresis[i] : 0;
+    bool in_zone = ((uint32_t)distance + margin >= zone_min[i] && distance <= (uint32_t)zone_max[i] + margin);
+    countZoneSample(i, in_zone, distance, certainty);
+}
+
+void VL53L1XZoneMonitorBase::countZoneSample(size_t i, bool in_zone, uint16_t distance, uint8_t certainty)
+{
+    if (zone_certainty[i])
+        certainty = zone_certainty[i];
+    if (in_zone)
+    {
+        if (zone_in_count[i] < UINT8_MAX)
+            zone_in_count[i]++;
+        zone_out_count[i] = 0;
+        if (zone_in_count[i] >= certainty && !testBit(zone_present, i))
+        {
+            setBit(zone_present, i);
+            clearBit(zone_approaching, i);
+            emitZoneEvent(i, ZoneEvent::Enter, distance);
+        }
+    }
+    else
+    {
+        if (zone_out_count[i] < UINT8_MAX)
+            zone_out_count[i]++;
+        zone_in_count[i] = 0;
+        if (zone_out_count[i] >= certainty && testBit(zone_present, i))
+        {
+            clearBit(zone_present, i);
+            emitZoneEvent(i, ZoneEvent::Exit, distance);
+        }
+    }
+}
+
+void VL53L1XZoneMonitorBase::emitZoneEvent(size_t i, ZoneEvent::Type type, uint16_t distance, uint16_t eta_ms, bool measured)
+{
+#if VL53L1XZONEMONITOR_MAX_COUNTERS > 0
+    if (counter_count > 0 && type != ZoneEvent::Approach && measured)
+        updatePassageCounters(i, type == ZoneEvent::Enter);
+#else
+    (void)measured;
+#endif
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+    if (zone_groups[i] && type != ZoneEvent::Approach)
+        updateZoneGroups(i, type == ZoneEvent::Enter);
+#endif
+    if (event_queue)
+    {
+        ZoneEvent event = {(uint16_t)i, type, zone_generation[i], distance, eta_ms, last_sample.timestamp};
+        event_queue->push(event);
+    }
+    else
+    {
+        runZoneCallback(zone_callbacks[i], i, type, distance, eta_ms);
+    }
+}
+
+#if VL53L1XZONEMONITOR_ENABLE_MOTION
+void VL53L1XZoneMonitorBase::predictZoneEntries(uint16_t distance, uint8_t roi)
+{
+    // Slower movement is sensor noise rather than an approach.
+    const uint16_t min_speed = 50;
+    const VL53L1XMotionTracker &tracker = trackers[roi];
+    for (size_t i = 0; i < zone_slots; i++)
+    {
+        if (!isZoneSlotUsed(i) || zone_roi[i] != roi || testBit(zone_present, i))
+            continue;
+        uint32_t eta_ms = tracker.timeToReach(zone_min[i], zone_max[i], min_speed);
+        if (eta_ms == 0)
+            continue; // Inside the zone; the enter event follows.
+        if (eta_ms > 2 * (uint32_t)approach_lead_ms)
+        {
+            // Rearm only well outside the lead time, so noise cannot repeat the event.
+            clearBit(zone_approaching, i);
+        }
+        else if (eta_ms <= approach_lead_ms && !testBit(zone_approaching, i))
+        {
+            setBit(zone_approaching, i);
+            emitZoneEvent(i, ZoneEvent::Approach, distance, (uint16_t)eta_ms);
+            if (zones_moved)
+                return; // A callback deleted a zone and moved the later ones.
+        }
+    }
+}
+#endif
+
+#if VL53L1XZONEMONITOR_MAX_COUNTERS > 0
+void VL53L1XZoneMonitorBase::updatePassageCounters(size_t zone_index, bool entered)
+{
+    uint32_t now = last_sample.timestamp;
+    for (uint8_t c = 0; c < counter_count; c++)
+    {
+        PassageCounter &counter = counters[c];
+        uint8_t p = 0;
+        while (p < counter.zone_count && counter.zones[p] != zone_index)
+            p++;
+        if (p == counter.zone_count)
+            continue;
+
+        if (counter.direction != 0 && now - counter.last_time > counter.timeout_ms)
+            counter.direction = 0;
+        uint8_t last = counter.zone_count - 1;
+        if (entered)
+        {
+            counter.occupied |= 1 << p;
+            if (counter.direction == 0)
+            {
+                // Only an object entering at either end starts a passage.
+                if (p == 0 || p == last)
+                {
+                    counter.direction = p == 0 ? 1 : -1;
+                    counter.progress = 1;
+                }
+            }
+            else
+            {
+                uint8_t expected = counter.direction > 0 ? counter.progress : last - counter.progress;
+                if (counter.progress < counter.zone_count && p == expected)
+                    counter.progress++;
+            }
+        }
+        else
+        {
+            counter.occupied &= ~(1 << p);
+            if (counter.direction != 0 && counter.occupied == 0)
+            {
+                // Left the path: a passage if every zone was entered in order
+                // and the far end was left last.
+                int8_t direction = counter.direction;
+                counter.direction = 0;
+                if (counter.progress == counter.zone_count && p == (direction > 0 ? last : 0))
+                {
+                    if (direction > 0)
+                        counter.in_count++;
+                    else
+                        counter.out_count++;
+                    if (event_queue)
+                    {
+                        // Dispatched with the zone events, so that the callback runs in the application's context.
+                        ZoneEvent event = {(uint16_t)zone_index, ZoneEvent::Passage, 0, last_sample.distance, 0,
+                                           last_sample.timestamp};
+                        event.source.index = c;
+                        event.source.value = direction;
+                        event_queue->push(event);
+                    }
+                    else
+                    {
+                        PassageCallback on_passage = counter.on_passage;
+                        if (on_passage)
+                            on_passage(direction);
+                    }
+                }
+            }
+        }
+        counter.last_time = now;
+    }
+}
+
+void VL53L1XZoneMonitorBase::abandonPassages()
+{
+    for (uint8_t c = 0; c < counter_count; c++)
+    {
+        counters[c].direction = 0;
+        counters[c].progress = 0;
+        counters[c].occupied = 0;
+    }
+}
+
+void VL53L1XZoneMonitorBase::releasePassageZone(size_t zone_index, bool shifted)
+{
+    for (uint8_t c = 0; c < counter_count; c++)
+    {
+        PassageCounter &counter = counters[c];
+        for (uint8_t p = 0; p < counter.zone_count; p++)
+        {
+            if (counter.zones[p] == zone_index)
+            {
+                // Inside a transaction the slot keeps its index and may be refilled.
+                if (shifted || config_depth == 0)
+                    counter.zone_count = 0;
+                counter.occupied &= ~(1 << p);
+            }
+            else if (shifted && counter.zones[p] > zone_index)
+            {
+                counter.zones[p]--;
+            }
+        }
+    }
+    while (counter_count > 0 && counters[counter_count - 1].zone_count == 0)
+        counter_count--;
+}
+
+uint8_t VL53L1XZoneMonitorBase::addPassageCounter(const size_t *zones, uint8_t count, uint32_t timeout_ms,
+                                                  PassageCallback onPassage)
+{
+    if (count < 2 || count > MAX_PASSAGE_ZONES)
+        return INVALID_COUNTER;
+
+    StateLock lock(*this);
+    for (uint8_t p = 0; p < count; p++)
+    {
+        if (!isZoneSlotUsed(zones[p]))
+            return INVALID_COUNTER;
+    }
+    uint8_t c = 0;
+    while (c < counter_count && counters[c].zone_count != 0)
+        c++;
+    if (c == MAX_COUNTERS)
+        return INVALID_COUNTER;
+
+    PassageCounter &counter = counters[c];
+    counter.zone_count = count;
+    counter.occupied = 0;
+    for (uint8_t p = 0; p < count; p++)
+    {
+        counter.zones[p] = (uint16_t)zones[p];
+        if (testBit(zone_present, zones[p]))
+            counter.occupied |= 1 << p;
+    }
+    counter.progress = 0;
+    counter.direction = 0;
+    counter.timeout_ms = timeout_ms;
+    counter.last_time = 0;
+    counter.in_count = 0;
+    counter.out_count = 0;
+    counter.on_passage = onPassage;
+    if (c == counter_count)
+        counter_count++;
+    return c;
+}
+
+void VL53L1XZoneMonitorBase::removePassageCounter(uint8_t counter)
+{
+    StateLock lock(*this);
+    if (counter >= counter_count)
+        return;
+    counters[counter].zone_count = 0;
+    while (counter_count > 0 && counters[counter_count - 1].zone_count == 0)
+        counter_count--;
+}
+
+uint32_t VL53L1XZoneMonitorBase::getPassagesIn(uint8_t counter) const
+{
+    return counter < counter_count && counters[counter].zone_count ? counters[counter].in_count : 0;
+}
+
+uint32_t VL53L1XZoneMonitorBase::getPassagesOut(uint8_t counter) const
+{
+    return counter < counter_count && counters[counter].zone_count ? counters[counter].out_count : 0;
+}
+
+void VL53L1XZoneMonitorBase::resetPassageCounter(uint8_t counter)
+{
+    StateLock lock(*this);
+    if (counter >= counter_count)
+        return;
+    counters[counter].in_count = 0;
+    counters[counter].out_count = 0;
+    counters[counter].direction = 0;
+}
+#endif
+
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+void VL53L1XZoneMonitorBase::updateZoneGroups(size_t zone_index, bool entered)
+{
+    uint8_t mask = zone_groups[zone_index];
+    for (uint8_t g = 0; g < group_count; g++)
+    {
+        if (!((mask >> g) & 1))
+            continue;
+        ZoneGroup &group = groups[g];
+        if (entered)
+        {
+            group.occupied++;
+            if (group.nearest == INVALID_ZONE || zone_min[zone_index] < zone_min[group.nearest] ||
+                (zone_min[zone_index] == zone_min[group.nearest] && zone_index < group.nearest))
+                group.nearest = zone_index;
+        }
+        else
+        {
+            if (group.occupied > 0)
+                group.occupied--;
+            if (group.nearest == zone_index)
+            {
+                if (group.occupied > 0)
+                    refreshZoneGroup(g);
+                else
+                    group.nearest = INVALID_ZONE;
+            }
+        }
+        group_changes |= 1 << g;
+    }
+}
+
+void VL53L1XZoneMonitorBase::refreshZoneGroup(uint8_t group)
+{
+    ZoneGroup &state = groups[group];
+    state.occupied = 0;
+    state.nearest = INVALID_ZONE;
+    for (size_t i = 0; i < zone_slots; i++)
+    {
+        if (!isZoneSlotUsed(i) || !((zone_groups[i] >> group) & 1) || !testBit(zone_present, i))
+            continue;
+        state.occupied++;
+        if (state.nearest == INVALID_ZONE || zone_min[i] < zone_min[state.nearest])
+            state.nearest = i;
+    }
+    if (state.nearest != state.reported)
+        group_changes |= 1 << group;
+}
+
+void VL53L1XZoneMonitorBase::resyncZoneGroups()
+{
+    for (uint8_t g = 0; g < group_count; g++)
+    {
+        if (!groups[g].used)
+            continue;
+        refreshZoneGroup(g);
+        groups[g].reported = groups[g].nearest;
+    }
+    group_changes = 0;
+}
+
+void VL53L1XZoneMonitorBase::reportZoneGroups()
+{
+    // A callback may change the groups, so each one is taken off the mask before it is reported.
+    while (group_changes)
+    {
+        uint8_t g = 0;
+        while (!((group_changes >> g) & 1))
+            g++;
+        group_changes &= (uint8_t)~(1 << g);
+        ZoneGroup &group = groups[g];
+        if (!group.used || group.nearest == group.reported)
+            continue;
+        GroupChange change = group.reported == INVALID_ZONE ? GroupOccupied
+                             : group.nearest == INVALID_ZONE ? GroupEmpty
+                                                             : NearestChanged;
+        group.reported = group.nearest;
+        if (event_queue)
+        {
+            // Dispatched with the zone events, so that the callback runs in the application's context.
+            ZoneEvent event = {group.nearest == INVALID_ZONE ? (uint16_t)UINT16_MAX : (uint16_t)group.nearest,
+                               ZoneEvent::GroupChange, 0, last_sample.distance, 0, last_sample.timestamp};
+            event.source.index = g;
+            event.source.value = (int8_t)change;
+            event_queue->push(event);
+            continue;
+        }
+        ZoneGroupCallback on_change = group.on_change;
+        if (on_change)
+            on_change(change, group.nearest);
+    }
+}
+
+uint8_t VL53L1XZoneMonitorBase::addZoneGroup(const size_t *zones, size_t count, ZoneGroupCallback onChange)
+{
+    StateLock lock(*this);
+    for (size_t k = 0; k < count; k++)
+    {
+        if (!isZoneSlotUsed(zones[k]))
+            return INVALID_GROUP;
+    }
+    uint8_t g = 0;
+    while (g < group_count && groups[g].used)
+        g++;
+    if (g == MAX_GROUPS)
+        return INVALID_GROUP;
+
+    for (size_t i = 0; i < zone_slots; i++)
+        zone_groups[i] &= (uint8_t)~(1 << g);
+    for (size_t k = 0; k < count; k++)
+        zone_groups[zones[k]] |= (uint8_t)(1 << g);
+    ZoneGroup &group = groups[g];
+    group.used = true;
+    group.on_change = onChange;
+    if (g == group_count)
+        group_count++;
+    // The group starts from the current occupancy without reporting it.
+    refreshZoneGroup(g);
+    group.reported = group.nearest;
+    group_changes &= (uint8_t)~(1 << g);
+    return g;
+}
+
+bool VL53L1XZoneMonitorBase::addZoneToGroup(uint8_t group, size_t zone_index)
+{
+    StateLock lock(*this);
+    if (group >= group_count || !groups[group].used || !isZoneSlotUsed(zone_index))
+        return false;
+    zone_groups[zone_index] |= (uint8_t)(1 << group);
+    refreshZoneGroup(group);
+    return true;
+}
+
+bool VL53L1XZoneMonitorBase::removeZoneFromGroup(uint8_t group, size_t zone_index)
+{
+    StateLock lock(*this);
+    if (group >= group_count || !groups[group].used || !isZoneSlotUsed(zone_index))
+        return false;
+    zone_groups[zone_index] &= (uint8_t)~(1 << group);
+    refreshZoneGroup(group);
+    return true;
+}
+
+void VL53L1XZoneMonitorBase::removeZoneGroup(uint8_t group)
+{
+    StateLock lock(*this);
+    if (group >= group_count)
+        return;
+    groups[group].used = false;
+    groups[group].on_change = nullptr;
+    group_changes &= (uint8_t)~(1 << group);
+    for (size_t i = 0; i < zone_slots; i++)
+        zone_groups[i] &= (uint8_t)~(1 << group);
+    while (group_count > 0 && !groups[group_count - 1].used)
+        group_count--;
+}
+
+bool VL53L1XZoneMonitorBase::isZoneGroupOccupied(uint8_t group) const
+{
+    return group < group_count && groups[group].used && groups[group].occupied > 0;
+}
+
+size_t VL53L1XZoneMonitorBase::getNearestOccupiedZone(uint8_t group) const
+{
+    return group < group_count && groups[group].used ? groups[group].nearest : INVALID_ZONE;
+}
+#endif
+
+void VL53L1XZoneMonitorBase::runZoneCallback(ZoneCallbacks callbacks, size_t zone_index, ZoneEvent::Type type, uint16_t distance,
+                                             uint16_t eta_ms)
+{
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+    // A callback may delete its own zone; its timing is then only kept in the totals.
+    uint8_t generation = zone_generation[zone_index];
+    uint32_t start_us = micros();
+#else
+    (void)zone_index;
+#endif
+    if (type == ZoneEvent::Enter)
+    {
+        if (callbacks.on_enter)
+            callbacks.on_enter(distance);
+    }
+    else if (type == ZoneEvent::Approach)
+    {
+#if VL53L1XZONEMONITOR_ENABLE_MOTION
+        if (callbacks.on_approach)
+            callbacks.on_approach(eta_ms);
+#else
+        (void)eta_ms;
+#endif
+    }
+    else if (callbacks.on_exit)
+    {
+        callbacks.on_exit();
+    }
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+    uint32_t elapsed_us = micros() - start_us;
+    if (elapsed_us > stats.callback_us.max_us)
+        stats.slowest_callback_zone = zone_index;
+    stats.callback_us.record(elapsed_us);
+    if (isZoneSlotUsed(zone_index) && zone_generation[zone_index] == generation)
+        zone_callback_us[zone_index].record(elapsed_us);
+#endif
+}
+
+bool VL53L1XZoneMonitorBase::isZoneActive(size_t i) const
+{
+    return zone_in_count[i] > 0 || testBit(zone_present, i);
+}
+
+bool VL53L1XZoneMonitorBase::update()
+{
+#if defined(ESP32)
+    if (acquisition_task)
+        return false;
+#endif
+    return performUpdate();
+}
+
+void VL53L1XZoneMonitorBase::setSampleFilter(uint32_t status_mask, float min_signal_mcps, float max_ambient_mcps)
+{
+    StateLock lock(*this);
+    accepted_statuses = status_mask;
+    min_signal_rate = min_signal_mcps;
+    max_ambient_rate = max_ambient_mcps;
+}
+
+uint32_t VL53L1XZoneMonitorBase::getSampleFilter() const
+{
+    return accepted_statuses;
+}
+
+bool VL53L1XZoneMonitorBase::passesSampleFilter(bool from_sensor) const
+{
+    if (accepted_statuses != ALL_RANGE_STATUSES)
+    {
+        if (last_sample.range_status >= 32 || !(accepted_statuses & (1UL << last_sample.range_status)))
+            return false;
+    }
+    if (from_sensor)
+    {
+        if (min_signal_rate > 0 && sensor.ranging_data.peak_signal_count_rate_MCPS < min_signal_rate)
+            return false;
+        if (max_ambient_rate > 0 && sensor.ranging_data.ambient_count_rate_MCPS > max_ambient_rate)
+            return false;
+    }
+    return true;
+}
+
+uint8_t VL53L1XZoneMonitorBase::measureConfidence(bool from_sensor) const
+{
+    uint8_t status = last_sample.range_status;
+    if (status != VL53L1X::RangeValid && status != VL53L1X::RangeValidMinRangeClipped &&
+        status != VL53L1X::RangeValidNoWrapCheckFail)
+        return 0;
+    uint8_t confidence = 255;
+    if (from_sensor)
+    {
+        float signal = sensor.ranging_data.peak_signal_count_rate_MCPS;
+        float total = signal + sensor.ranging_data.ambient_count_rate_MCPS;
+        confidence = total > 0 ? (uint8_t)(255 * signal / total + 0.5f) : 0;
+    }
+    return status == VL53L1X::RangeValid ? confidence : confidence / 2;
+}
+
+void VL53L1XZoneMonitorBase::setMinConfidence(uint8_t confidence)
+{
+    StateLock lock(*this);
+    min_confidence = confidence;
+}
+
+uint8_t VL53L1XZoneMonitorBase::getMinConfidence() const
+{
+    return min_confidence;
+}
+
+#if VL53L1XZONEMONITOR_ENABLE_PREFILTER
+bool VL53L1XZoneMonitorBase::setPrefilter(VL53L1XDistanceFilter::Mode mode, uint8_t parameter)
+{
+    StateLock lock(*this);
+    for (uint8_t r = 0; r < MAX_ROIS; r++)
+    {
+        if (!prefilters[r].configure(mode, parameter))
+            return false;
+    }
+    return true;
+}
+
+const VL53L1XDistanceFilter &VL53L1XZoneMonitorBase::getPrefilter() const
+{
+    return prefilters[0];
+}
+#endif
+
+void VL53L1XZoneMonitorBase::setSampleSource(VL53L1XSampleSource *source)
+{
+    StateLock lock(*this);
+    sample_source = source;
+}
+
+VL53L1XSampleSource *VL53L1XZoneMonitorBase::getSampleSource() const
+{
+    return sample_source;
+}
+
+uint32_t VL53L1XZoneMonitorBase::currentTime() const
+{
+    return sample_source ? sample_source->now() : millis();
+}
+
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+void VL53L1XTimingStats::record(uint32_t elapsed_us)
+{
+    if (count == 0 || elapsed_us < min_us)
+        min_us = elapsed_us;
+    if (elapsed_us > max_us)
+        max_us = elapsed_us;
+    total_us += elapsed_us;
+    count++;
+}
+
+uint32_t VL53L1XTimingStats::getAverage() const
+{
+    return count ? total_us / count : 0;
+}
+
+const VL53L1XMonitorStats &VL53L1XZoneMonitorBase::getStats() const
+{
+    return stats;
+}
+
+VL53L1XTimingStats VL53L1XZoneMonitorBase::getZoneCallbackStats(size_t zone_index) const
+{
+    StateLock lock(*this);
+    return isZoneSlotUsed(zone_index) ? zone_callback_us[zone_index] : VL53L1XTimingStats();
+}
+
+void VL53L1XZoneMonitorBase::resetStats()
+{
+    StateLock lock(*this);
+    stats = VL53L1XMonitorStats();
+    for (size_t i = 0; i < zone_slots; i++)
+        zone_callback_us[i] = VL53L1XTimingStats();
+}
+#endif
+
+void VL53L1XZoneMonitorBase::setEventQueue(ZoneEventQueue *queue)
+{
+    StateLock lock(*this);
+    event_queue = queue;
+}
+
+ZoneEventQueue *VL53L1XZoneMonitorBase::getEventQueue() const
+{
+    return event_queue;
+}
+
+#if VL53L1XZONEMONITOR_ENABLE_SAMPLE_LOG
+void VL53L1XZoneMonitorBase::setSampleLog(VL53L1XSampleLog *log)
+{
+    StateLock lock(*this);
+    sample_log = log;
+}
+
+VL53L1XSampleLog *VL53L1XZoneMonitorBase::getSampleLog() const
+{
+    return sample_log;
+}
+#endif
+
+bool VL53L1XZoneMonitorBase::isQueuedEventLive(const ZoneEvent &event) const
+{
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+    if (event.type == ZoneEvent::GroupChange)
+        return event.source.index < group_count && groups[event.source.index].used;
+#endif
+#if VL53L1XZONEMONITOR_MAX_COUNTERS > 0
+    if (event.type == ZoneEvent::Passage)
+        return event.source.index < counter_count && counters[event.source.index].zone_count > 0;
+#endif
+    return isZoneSlotUsed(event.zone) && zone_generation[event.zone] == event.generation;
+}
+
+size_t VL53L1XZoneMonitorBase::pollEvents(ZoneEvent *events, size_t max_events)
+{
+    size_t polled = 0;
+    while (event_queue && polled < max_events && event_queue->pop(events[polled]))
+    {
+        if (isQueuedEventLive(events[polled]))
+            polled++;
+    }
+    return polled;
+}
+
+size_t VL53L1XZoneMonitorBase::dispatchEvents(size_t max_events)
+{
+    size_t dispatched = 0;
+    ZoneEvent event;
+    while (event_queue && dispatched < max_events && event_queue->pop(event))
+    {
+        dispatched++;
+        if (!isQueuedEventLive(event))
+            continue;
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+        if (event.type == ZoneEvent::GroupChange)
+        {
+            ZoneGroupCallback on_change = groups[event.source.index].on_change;
+            if (on_change)
+                on_change((GroupChange)event.source.value, event.zone == UINT16_MAX ? INVALID_ZONE : event.zone);
+            continue;
+        }
+#endif
+#if VL53L1XZONEMONITOR_MAX_COUNTERS > 0
+        if (event.type == ZoneEvent::Passage)
+        {
+            PassageCallback on_passage = counters[event.source.index].on_passage;
+            if (on_passage)
+                on_passage(event.source.value);
+            continue;
+        }
+#endif
+        // Passed by value, since a callback may delete or replace its own zone.
+        runZoneCallback(zone_callbacks[event.zone], event.zone, event.type, event.distance, event.eta_ms);
+    }
+    return dispatched;
+}
+
+#if defined(ESP32)
+bool VL53L1XZoneMonitorBase::startTask(ZoneEventQueue &queue, BaseType_t core, UBaseType_t priority, uint32_t stack_size)
+{
+    if (acquisition_task)
+        return false;
+    if (!state_mutex)
+    {
+        state_mutex = xSemaphoreCreateRecursiveMutex();
+        if (!state_mutex)
+            return false;
+    }
+
+    setEventQueue(&queue);
+    StateLock lock(*this);
+    if (xTaskCreatePinnedToCore(acquisitionTaskMain, "VL53L1XMonitor", stack_size, this, priority, &acquisition_task, core) != pdPASS)
+    {
+        acquisition_task = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void VL53L1XZoneMonitorBase::stopTask()
+{
+    if (!acquisition_task)
+        return;
+    // Holding the mutex guarantees the task is not in the middle of an update.
+    StateLock lock(*this);
+    vTaskDelete(acquisition_task);
+    acquisition_task = nullptr;
+}
+
+bool VL53L1XZoneMonitorBase::isTaskRunning() const
+{
+    return acquisition_task != nullptr;
+}
+
+void VL53L1XZoneMonitorBase::acquisitionTaskMain(void *arg)
+{
+    VL53L1XZoneMonitorBase *monitor = static_cast<VL53L1XZoneMonitorBase *>(arg);
+    for (;;)
+    {
+        // In single-shot mode the task also wakes to trigger the next measurement.
+        uint32_t wait_ms = monitor->current_interval_ms;
+        if (monitor->single_shot)
+            wait_ms = std::min(monitor->getNextWakeDelay(), wait_ms);
+        if (monitor->interrupt_pin != NO_INTERRUPT_PIN)
+        {
+            // The timeout recovers from a missed edge by checking the pin level.
+            TickType_t timeout = pdMS_TO_TICKS(monitor->single_shot ? wait_ms : 2 * wait_ms + 1);
+            if (ulTaskNotifyTake(pdTRUE, timeout) == 0 && digitalRead(monitor->interrupt_pin) == LOW)
+                monitor->data_ready_flag = true;
+        }
+        else
+        {
+            TickType_t delay_ticks = pdMS_TO_TICKS(wait_ms);
+            vTaskDelay(delay_ticks > 0 ? delay_ticks : 1);
+        }
+
+        // An asynchronous read takes several steps; other tasks run in between.
+        for (;;)
+        {
+            {
+                StateLock lock(*monitor);
+                monitor->performUpdate();
+                if (monitor->pending_read.phase == ReadIdle)
+                    break;
+            }
+            taskYIELD();
+        }
+    }
+}
+#endif
+
+VL53L1XZoneMonitor::VL53L1XZoneMonitor(TwoWire *wire, uint32_t interval_ms, size_t certainty)
+    : VL53L1XZoneMonitorBase(wire, interval_ms, certainty), free_slots(0)
+{
+}
+
+void VL53L1XZoneMonitor::syncZoneBuffers()
+{
+    zone_min = min_storage.data();
+    zone_max = max_storage.data();
+    zone_in_count = in_count_storage.data();
+    zone_out_count = out_count_storage.data();
+    zone_hysteresis = hysteresis_storage.data();
+    zone_certainty = certainty_storage.data();
+    zone_roi = roi_storage.data();
+    zone_present = present_storage.data();
+    zone_approaching = approaching_storage.data();
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+    zone_groups = group_storage.data();
+#endif
+    zone_generation = generation_storage.data();
+    zone_used = free_slots ? used_storage.data() : nullptr;
+    zone_callbacks = callback_storage.data();
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+    zone_callback_us = callback_stats_storage.data();
+#endif
+    zone_slots = min_storage.size();
+    index_bounds = index_bound_storage.data();
+    index_offsets = index_offset_storage.data();
+    index_members = index_member_storage.data();
+    active_zones = active_storage.data();
+    candidate_zones = candidate_storage.data();
+}
+
+size_t VL53L1XZoneMonitor::allocateZoneSlot()
+{
+    if (free_slots > 0)
+    {
+        for (size_t i = 0; i < min_storage.size(); i++)
+        {
+            if (!testBit(used_storage.data(), i))
+            {
+                setBit(used_storage.data(), i);
+                free_slots--;
+                syncZoneBuffers();
+                return i;
+            }
+        }
+    }
+
+    size_t count = min_storage.size();
+    if (count >= UINT16_MAX)
+        return INVALID_ZONE;
+    min_storage.push_back(0);
+    max_storage.push_back(0);
+    in_count_storage.push_back(0);
+    out_count_storage.push_back(0);
+    hysteresis_storage.push_back(0);
+    certainty_storage.push_back(0);
+    roi_storage.push_back(0);
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+    group_storage.push_back(0);
+#endif
+    generation_storage.push_back(0);
+    present_storage.resize((count + 8) / 8);
+    approaching_storage.resize((count + 8) / 8);
+    used_storage.resize((count + 8) / 8);
+    setBit(used_storage.data(), count);
+    callback_storage.push_back(ZoneCallbacks());
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+    callback_stats_storage.push_back(VL53L1XTimingStats());
+#endif
+    active_storage.resize(count + 1);
+    candidate_storage.resize(count + 1);
+    syncZoneBuffers();
+    return count;
+}
+
+void VL53L1XZoneMonitor::eraseBit(uint8_t *bits, size_t index, size_t count)
+{
+    for (size_t i = index; i + 1 < count; i++)
+    {
+        if (testBit(bits, i + 1))
+            setBit(bits, i);
+        else
+            clearBit(bits, i);
+    }
+    clearBit(bits, count - 1);
+}
+
+bool VL53L1XZoneMonitor::releaseZoneSlot(size_t zone_index, bool keep_indices)
+{
+    size_t count = min_storage.size();
+    if (keep_indices)
+    {
+        clearBit(used_storage.data(), zone_index);
+        free_slots++;
+    }
+    else
+    {
+        min_storage.erase(min_storage.begin() + zone_index);
+        max_storage.erase(max_storage.begin() + zone_index);
+        in_count_storage.erase(in_count_storage.begin() + zone_index);
+        out_count_storage.erase(out_count_storage.begin() + zone_index);
+        hysteresis_storage.erase(hysteresis_storage.begin() + zone_index);
+        certainty_storage.erase(certainty_storage.begin() + zone_index);
+        roi_storage.erase(roi_storage.begin() + zone_index);
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+        group_storage.erase(group_storage.begin() + zone_index);
+#endif
+        generation_storage.erase(generation_storage.begin() + zone_index);
+        callback_storage.erase(callback_storage.begin() + zone_index);
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+        callback_stats_storage.erase(callback_stats_storage.begin() + zone_index);
+#endif
+        eraseBit(present_storage.data(), zone_index, count);
+        eraseBit(approaching_storage.data(), zone_index, count);
+        eraseBit(used_storage.data(), zone_index, count);
+        count--;
+    }
+    // Trailing free slots are dropped; the vectors keep their capacity.
+    while (free_slots > 0 && !testBit(used_storage.data(), count - 1))
+    {
+        count--;
+        free_slots--;
+    }
+    min_storage.resize(count);
+    max_storage.resize(count);
+    in_count_storage.resize(count);
+    out_count_storage.resize(count);
+    hysteresis_storage.resize(count);
+    certainty_storage.resize(count);
+    roi_storage.resize(count);
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+    group_storage.resize(count);
+#endif
+    generation_storage.resize(count);
+    callback_storage.resize(count);
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+    callback_stats_storage.resize(count);
+#endif
+    syncZoneBuffers();
+    return !keep_indices;
+}
+
+size_t VL53L1XZoneMonitor::getZoneCapacity() const
+{
+    return UINT16_MAX;
+}
+
+bool VL53L1XZoneMonitor::reserveZoneIndex(size_t bound_count, size_t member_count)
+{
+    // index_offsets holds 16-bit positions; a larger index is replaced by the linear scan.
+    if (member_count > UINT16_MAX)
+        return false;
+    if (index_bound_storage.size() < bound_count)
+        index_bound_storage.resize(bound_count);
+    if (index_offset_storage.size() < bound_count + 1)
+        index_offset_storage.resize(bound_count + 1);
+    if (index_member_storage.size() < member_count)
+        index_member_storage.resize(member_count);
+    syncZoneBuffers();
+    return true;
 }
@@ -2,8 +2,110 @@
 #define VL53L1XZONEMONITOR_H
 
 #include <VL53L1X.h>
+
+/**
+ * Set to 1 (e.g. with -DVL53L1XZONEMONITOR_ENABLE_STATS=1) to collect timing
+ * and I²C statistics through getStats(). Disabled builds carry no overhead.
+ */
+#ifndef VL53L1XZONEMONITOR_ENABLE_STATS
+#define VL53L1XZONEMONITOR_ENABLE_STATS 0
+#endif
+
+/**
+ * Maximum number of regions of interest a monitor can scan. Each region costs
+ * about 70 bytes for its prefilter, motion tracker and background model, so
+ * RAM-constrained boards may lower it.
+ */
+#ifndef VL53L1XZONEMONITOR_MAX_ROIS
+#define VL53L1XZONEMONITOR_MAX_ROIS 4
+#endif
+
+/**
+ * Maximum number of passage counters per monitor. Each counter costs about
+ * 40 bytes of RAM; 0 removes passage counting altogether.
+ */
+#ifndef VL53L1XZONEMONITOR_MAX_COUNTERS
+#define VL53L1XZONEMONITOR_MAX_COUNTERS 2
+#endif
+
+/**
+ * Maximum number of zone groups per monitor, at most 8. Each group costs
+ * about 20 bytes of RAM, and every zone one byte; 0 removes zone groups
+ * altogether.
+ */
+#ifndef VL53L1XZONEMONITOR_MAX_GROUPS
+#define VL53L1XZONEMONITOR_MAX_GROUPS 4
+#endif
+
+/**
+ * Set to 0 to remove single-shot ranging and the trigger state it keeps;
+ * isSingleShot() then always returns false.
+ */
+#ifndef VL53L1XZONEMONITOR_ENABLE_SINGLE_SHOT
+#define VL53L1XZONEMONITOR_ENABLE_SINGLE_SHOT 1
+#endif
+
+/**
+ * Set to 0 to remove fault detection and recovery, together with the health
+ * callback and the recovery state; getHealth() then always reports Healthy.
+ */
+#ifndef VL53L1XZONEMONITOR_ENABLE_FAULT_RECOVERY
+#define VL53L1XZONEMONITOR_ENABLE_FAULT_RECOVERY 1
+#endif
+
+/**
+ * Set to 0 to remove setPrefilter() and the distance filter kept for each
+ * region of interest; zones then evaluate the raw distance.
+ */
+#ifndef VL53L1XZONEMONITOR_ENABLE_PREFILTER
+#define VL53L1XZONEMONITOR_ENABLE_PREFILTER 1
+#endif
+
+/**
+ * Set to 0 to remove motion tracking and approach events, together with the
+ * tracker of each region of interest and the approach callback of each zone.
+ */
+#ifndef VL53L1XZONEMONITOR_ENABLE_MOTION
+#define VL53L1XZONEMONITOR_ENABLE_MOTION 1
+#endif
+
+/**
+ * Set to 0 to remove background suppression and the background model kept
+ * for each region of interest.
+ */
+#ifndef VL53L1XZONEMONITOR_ENABLE_BACKGROUND
+#define VL53L1XZONEMONITOR_ENABLE_BACKGROUND 1
+#endif
+
+/**
+ * Set to 0 to remove setSampleLog() and its pointer from every monitor.
+ */
+#ifndef VL53L1XZONEMONITOR_ENABLE_SAMPLE_LOG
+#define VL53L1XZONEMONITOR_ENABLE_SAMPLE_LOG 1
+#endif
+
+#include "ZoneDelegate.h"
+#include "ZoneEventQueue.h"
+#include "VL53L1XSampleSource.h"
+#include "VL53L1XDistanceFilter.h"
+#include "VL53L1XSampleLog.h"
+#include "VL53L1XMotionTracker.h"
+#include "VL53L1XBackgroundModel.h"
+#include "VL53L1XBusLock.h"
 #include <vector>
-#include <functional>
+#include <algorithm>
+#include <iterator>
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#endif
+
+typedef ZoneDelegate<void(uint16_t distance)> ZoneEnterCallback; /**< Callback for an object entering a zone. */
+typedef ZoneDelegate<void()> ZoneExitCallback;                   /**< Callback for an object leaving a zone. */
+typedef ZoneDelegate<void(uint16_t eta_ms)> ZoneApproachCallback; /**< Callback for an object predicted to enter a zone. */
+typedef ZoneDelegate<void(int8_t direction)> PassageCallback;     /**< Callback for a counted passage; +1 in, -1 out. */
 
 /**
  * @brief Represents a single monitoring zone for the VL53L1X sensor.
@@ -12,17 +114,21 @@
  * class tracks whether an object is currently in the zone based on measurements
  * and triggers callbacks for entering and exiting events when the configured
  * certainty threshold is met.
+ *
+ * ZoneObserver can be used on its own. Zones added to a monitor are stored in
+ * a packed layout instead and are inspected through ZoneView.
  */
 class ZoneObserver {
 public:
     uint16_t min_distance;                          /**< Minimum distance for the zone in millimeters. */
     uint16_t max_distance;                          /**< Maximum distance for the zone in millimeters. */
     bool object_present;                            /**< Flag indicating whether an object is currently in the zone. */
-    std::function<void(uint16_t distance)> on_enter; /**< Callback function triggered when an object enters the zone. */
-    std::function<void()> on_exit;                 /**< Callback function triggered when an object exits the zone. */
+    ZoneEnterCallback on_enter;                     /**< Callback function triggered when an object enters the zone. */
+    ZoneExitCallback on_exit;                       /**< Callback function triggered when an object exits the zone. */
 
     size_t in_zone_count;  /**< Counter for consecutive in-zone measurements. */
     size_t out_zone_count; /**< Counter for consecutive out-of-zone measurements. */
+    uint16_t hysteresis;   /**< Margin in millimeters by which an object must leave the zone before it counts as out. */
 
     /**
      * @brief Constructs a ZoneObserver object.
@@ -32,14 +138,15 @@ public:
      * @param onEnter Callback function to execute when an object enters the zone.
      * @param onExit Callback function to execute when an object exits the zone.
      */
-    ZoneObserver(uint16_t min, uint16_t max, std::function<void(uint16_t)> onEnter = nullptr, std::function<void()> onExit = nullptr);
+    ZoneObserver(uint16_t min, uint16_t max, ZoneEnterCallback onEnter = nullptr, ZoneExitCallback onExit = nullptr);
 
     /**
      * @brief Evaluates the current distance measurement against the zone boundaries.
      *
      * This method checks if the distance is within the zone and updates the
      * counters for consecutive measurements. When the certainty factor is met,
-     * the appropriate callback (on_enter or on_exit) is triggered.
+     * the appropriate callback (on_enter or on_exit) is triggered. While an
+     * object is present, the zone is widened by the hysteresis margin.
      *
      * @param distance Distance measured by the sensor in millimeters.
      * @param certainty Number of consecutive measurements required for stability.
@@ -55,176 +162,2278 @@ public:
 };
 
 /**
- * @brief High-level interface for monitoring multiple zones with a VL53L1X sensor.
+ * @brief Enter and exit callbacks of a zone, kept apart from the evaluation state.
+ */
+struct ZoneCallbacks {
+    ZoneEnterCallback on_enter;       /**< Callback function triggered when an object enters the zone. */
+    ZoneExitCallback on_exit;         /**< Callback function triggered when an object exits the zone. */
+#if VL53L1XZONEMONITOR_ENABLE_MOTION
+    ZoneApproachCallback on_approach; /**< Callback function triggered when an object is predicted to enter the zone. */
+#endif
+};
+
+/**
+ * @brief A single measurement read from the sensor.
+ */
+struct VL53L1XSample {
+    uint16_t distance;     /**< Distance evaluated by the zones in millimeters, after the prefilter. */
+    uint16_t raw_distance; /**< Distance reported by the sensor in millimeters. */
+    uint8_t range_status;  /**< VL53L1X::RangeStatus reported for the measurement. */
+    bool valid;            /**< False if the measurement was rejected or taken while reconfiguring; it was then not evaluated. */
+    bool background;       /**< True if the distance matched the learned background and was evaluated as no object. */
+    uint8_t roi;           /**< Region of interest the measurement was taken with; 0 without ROI scanning. */
+    int16_t velocity;      /**< Tracked velocity in mm/s, negative while approaching the sensor; 0 without motion tracking. */
+    uint8_t confidence;    /**< Confidence in the distance from 0 to 255, weighted by signal and ambient rate. */
+    uint32_t timestamp;    /**< millis() at the time the measurement was read. */
+    uint32_t sequence;     /**< Number of measurements read so far; 0 if none has been read yet. */
+};
+
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+/**
+ * @brief Minimum, average and maximum of a measured duration.
+ */
+struct VL53L1XTimingStats {
+    uint32_t min_us;   /**< Shortest duration in microseconds. */
+    uint32_t max_us;   /**< Longest duration in microseconds. */
+    uint32_t total_us; /**< Sum of all durations in microseconds. */
+    uint32_t count;    /**< Number of recorded durations. */
+
+    VL53L1XTimingStats() : min_us(0), max_us(0), total_us(0), count(0) {}
+
+    /**
+     * @brief Adds a duration.
+     *
+     * @param elapsed_us The duration in microseconds.
+     */
+    void record(uint32_t elapsed_us);
+
+    /**
+     * @brief Gets the average duration.
+     *
+     * @return The average in microseconds, or 0 if nothing was recorded.
+     */
+    uint32_t getAverage() const;
+};
+
+/**
+ * @brief Hot-path statistics of a monitor, collected when VL53L1XZONEMONITOR_ENABLE_STATS is set.
+ */
+struct VL53L1XMonitorStats {
+    uint32_t not_ready_polls;         /**< dataReady() polls that found no new measurement. */
+    uint32_t reads;                   /**< Measurements read from the sensor. */
+    uint32_t missed_samples;          /**< Measurements overwritten because update() was called too late. */
+    uint32_t rejected_samples;        /**< Measurements rejected by the sample filter. */
+    uint32_t bus_busy;                /**< update() calls that skipped the sensor because the bus lock was taken. */
+    uint32_t background_samples;      /**< Measurements matching the learned background, evaluated as no object. */
+    uint32_t sensor_faults;           /**< Failed I²C reads, invalid results and stalls detected by fault recovery. */
+    uint32_t recoveries;              /**< Successful re-initializations after a fault. */
+    VL53L1XTimingStats read_us;       /**< Time spent in the I²C read of a measurement. */
+    VL53L1XTimingStats evaluation_us; /**< Time spent evaluating zones, including inline callbacks. */
+    VL53L1XTimingStats callback_us;   /**< Time spent in each individual zone callback, over all zones. */
+    size_t slowest_callback_zone;     /**< Zone whose callback took callback_us.max_us, or SIZE_MAX if none or since deleted. */
+
+    VL53L1XMonitorStats()
+        : not_ready_polls(0), reads(0), missed_samples(0), rejected_samples(0), bus_busy(0), background_samples(0),
+          sensor_faults(0), recoveries(0), slowest_callback_zone(SIZE_MAX) {}
+};
+#endif
+
+/**
+ * @brief Region of interest of the SPAD array used for a measurement.
+ */
+struct VL53L1XRoi {
+    uint8_t width;  /**< Width in SPADs, 4 to 16. */
+    uint8_t height; /**< Height in SPADs, 4 to 16. */
+    uint8_t center; /**< SPAD number of the center, as taken by VL53L1X::setROICenter(); 199 is the optical center. */
+};
+
+class VL53L1XZoneMonitorBase;
+
+/**
+ * @brief Read-only view of a zone stored in a monitor.
  *
- * The VL53L1XZoneMonitor class manages multiple zones and provides configuration
- * options for distance mode, timing budget, and timeout. It also implements a
- * certainty factor to ensure stable detection before triggering callbacks.
+ * Returned by VL53L1XZoneMonitorBase::getZone(). An invalid view compares
+ * equal to nullptr, and the view supports `->`, so code written against the
+ * former ZoneObserver pointer, such as `getZone(i)->isObjectPresent()`, keeps
+ * working. The view stays valid until the zone is deleted.
  */
-class VL53L1XZoneMonitor {
+class ZoneView {
 private:
-    VL53L1X sensor;                  /**< Instance of the VL53L1X sensor. */
-    std::vector<ZoneObserver> zones; /**< List of defined zones. */
-    uint32_t update_interval_ms;     /**< Interval for continuous measurements in milliseconds. */
-    uint32_t last_update_time;       /**< Timestamp of the last measurement update. */
-    size_t certainty_factor;         /**< Number of consecutive measurements required for stability. */
+    const VL53L1XZoneMonitorBase *monitor; /**< Monitor owning the zone, or nullptr for an invalid view. */
+    size_t zone_index;                     /**< Slot of the zone in the monitor. */
 
+public:
     /**
-     * @brief Performs a measurement update and evaluates all zones.
+     * @brief Constructs a view of a zone slot.
      *
-     * This method reads the sensor data and updates the state of each zone,
-     * triggering callbacks if the certainty factor is met.
+     * @param owner Monitor owning the zone, or nullptr for an invalid view.
+     * @param index Slot of the zone in the monitor.
      */
-    void performUpdate();
+    ZoneView(const VL53L1XZoneMonitorBase *owner = nullptr, size_t index = 0) : monitor(owner), zone_index(index) {}
 
-public:
     /**
-     * @brief Constructs a VL53L1XZoneMonitor object.
+     * @brief Gets the minimum distance of the zone.
      *
-     * @param wire Optional pointer to a TwoWire object for custom I²C bus.
-     * @param interval_ms Interval for continuous measurements in milliseconds.
-     * @param certainty Number of consecutive measurements required for stability.
+     * @return Minimum distance in millimeters.
      */
-    VL53L1XZoneMonitor(TwoWire *wire = nullptr, uint32_t interval_ms = 50, size_t certainty = 1);
+    uint16_t getMinDistance() const;
 
     /**
-     * @brief Initializes the VL53L1X sensor.
+     * @brief Gets the maximum distance of the zone.
      *
-     * @return True if initialization is successful, false otherwise.
+     * @return Maximum distance in millimeters.
      */
-    bool init();
+    uint16_t getMaxDistance() const;
 
     /**
-     * @brief Sets the distance mode of the sensor.
+     * @brief Gets the number of consecutive in-zone measurements, saturating at 255.
      *
-     * The distance mode determines the trade-off between range and ambient
-     * light resistance. Available modes are Short, Medium, and Long.
+     * @return The in-zone count.
+     */
+    uint8_t getInZoneCount() const;
+
+    /**
+     * @brief Gets the number of consecutive out-of-zone measurements, saturating at 255.
      *
-     * @param mode The desired distance mode.
+     * @return The out-of-zone count.
      */
-    void setDistanceMode(VL53L1X::DistanceMode mode);
+    uint8_t getOutZoneCount() const;
 
     /**
-     * @brief Gets the current distance mode of the sensor.
+     * @brief Gets the exit hysteresis margin.
      *
-     * @return The current distance mode.
+     * @return The margin in millimeters.
      */
-    VL53L1X::DistanceMode getDistanceMode();
+    uint16_t getHysteresis() const;
 
     /**
-     * @brief Sets the measurement timing budget.
+     * @brief Gets the certainty factor of the zone.
      *
-     * The timing budget defines the time the sensor spends on a single measurement,
-     * affecting accuracy and measurement frequency.
+     * @return The zone's own certainty, or 0 if it uses the monitor's certainty factor.
+     */
+    uint8_t getCertainty() const;
+
+    /**
+     * @brief Gets the region of interest the zone is evaluated for.
      *
-     * @param budget_us The timing budget in microseconds.
+     * @return The index into the ROI scan list.
      */
-    void setMeasurementTimingBudget(uint32_t budget_us);
+    uint8_t getRoi() const;
 
     /**
-     * @brief Gets the current measurement timing budget.
+     * @brief Checks if an object is present in the zone.
      *
-     * @return The timing budget in microseconds.
+     * @return True if an object is present, false otherwise.
      */
-    uint32_t getMeasurementTimingBudget();
+    bool isObjectPresent() const;
 
     /**
-     * @brief Sets the timeout for sensor operations.
+     * @brief Checks if an approach event fired for the zone and the object has not entered or turned away since.
      *
-     * @param timeout Timeout duration in milliseconds.
+     * @return True if the object is predicted to enter the zone.
      */
-    void setTimeout(uint16_t timeout);
+    bool isApproaching() const;
 
     /**
-     * @brief Gets the current timeout duration.
+     * @brief Checks whether the zone state reflects the sensor.
      *
-     * @return Timeout duration in milliseconds.
+     * @return False while the sensor is recovering from a fault; the state
+     *         then follows the monitor's UnknownZonePolicy.
      */
-    uint16_t getTimeout();
+    bool isKnown() const;
 
     /**
-     * @brief Adds a new monitoring zone.
+     * @brief Gets the index of the zone in its monitor.
      *
-     * Each zone is defined by a minimum and maximum distance, with optional
-     * callbacks for entering and exiting events.
+     * @return The zone index.
+     */
+    size_t getIndex() const { return zone_index; }
+
+    explicit operator bool() const { return monitor != nullptr; }
+    bool operator==(std::nullptr_t) const { return monitor == nullptr; }
+    bool operator!=(std::nullptr_t) const { return monitor != nullptr; }
+    const ZoneView *operator->() const { return this; }
+};
+
+/**
+ * @brief High-level interface for monitoring multiple zones with a VL53L1X sensor.
+ *
+ * The VL53L1XZoneMonitorBase class manages multiple zones and provides configuration
+ * options for distance mode, timing budget, and timeout. It also implements a
+ * certainty factor to ensure stable detection before triggering callbacks.
+ *
+ * Zone storage is supplied by the derived class: VL53L1XZoneMonitor grows its
+ * storage on demand, while VL53L1XZoneMonitorT uses a fixed-capacity static
+ * array whose size is known at link time.
+ */
+class VL53L1XZoneMonitorBase {
+public:
+    static const uint8_t NO_INTERRUPT_PIN = 0xFF;  /**< Pin value selecting I²C polling instead of GPIO1 interrupts. */
+    static const uint8_t MAX_INTERRUPT_MONITORS = 8; /**< Maximum number of monitors using GPIO1 interrupts at once. */
+    static const size_t INVALID_ZONE = (size_t)-1;   /**< Zone index returned when no zone could be added. */
+    static const uint8_t MAX_ROIS = VL53L1XZONEMONITOR_MAX_ROIS; /**< Maximum number of regions of interest in a scan. */
+    static const uint8_t MAX_COUNTERS = VL53L1XZONEMONITOR_MAX_COUNTERS; /**< Maximum number of passage counters. */
+    static const uint8_t MAX_PASSAGE_ZONES = 4;      /**< Maximum number of zones in the path of a passage counter. */
+    static const uint8_t INVALID_COUNTER = 0xFF;     /**< Counter index returned when no counter could be added. */
+    static const uint8_t MAX_GROUPS = VL53L1XZONEMONITOR_MAX_GROUPS; /**< Maximum number of zone groups. */
+    static const uint8_t INVALID_GROUP = 0xFF;       /**< Group index returned when no group could be added. */
+    static const uint8_t NO_SHUTDOWN_PIN = 0xFF;     /**< Pin value for fault recovery without an XSHUT line. */
+    static const uint32_t ALL_RANGE_STATUSES = 0xFFFFFFFFUL; /**< Status mask accepting every measurement. */
+    static const uint32_t VALID_RANGE_STATUSES =            /**< Status mask accepting only measurements with a trusted distance. */
+        (1UL << VL53L1X::RangeValid) | (1UL << VL53L1X::RangeValidMinRangeClipped);
+
+    /**
+     * @brief Condition of the sensor as seen by fault recovery.
+     */
+    enum Health : uint8_t {
+        Healthy,   /**< Measurements arrive and are plausible. */
+        Degraded,  /**< The last reads failed or returned invalid data, fewer than the fault threshold in a row. */
+        Recovering /**< The sensor is being reset and re-initialized; zone states are unknown. */
+    };
+
+    /**
+     * @brief State zones report while the sensor is recovering.
+     */
+    enum UnknownZonePolicy : uint8_t {
+        KeepLastState, /**< Zones keep the state of the last measurement. */
+        ReportEmpty,   /**< Zones with an object present exit. */
+        ReportOccupied /**< Every empty zone enters, e.g. for a guard that must fail safe. */
+    };
+
+    typedef ZoneDelegate<void(Health health)> HealthCallback; /**< Callback for a change of the health state. */
+
+    /**
+     * @brief Aggregate change of a zone group.
+     */
+    enum GroupChange : uint8_t {
+        GroupOccupied,  /**< A zone of the empty group became occupied. */
+        NearestChanged, /**< The group stays occupied, but its nearest occupied zone changed. */
+        GroupEmpty      /**< The last occupied zone of the group became empty. */
+    };
+
+    typedef ZoneDelegate<void(GroupChange change, size_t nearest_zone)> ZoneGroupCallback; /**< Callback for a change of a zone group; nearest_zone is INVALID_ZONE once empty. */
+
+private:
+    static_assert(MAX_GROUPS <= 8, "VL53L1XZONEMONITOR_MAX_GROUPS must be between 0 and 8");
+
+    static const uint32_t RESET_PULSE_MS = 2;    /**< Time XSHUT is held low to reset the sensor. */
+    static const uint32_t BOOT_TIMEOUT_MS = 100; /**< Longest wait for the sensor to answer after a reset. */
+    static const uint32_t MIN_BACKOFF_MS = 100;  /**< Wait after the first failed recovery attempt. */
+    static const uint8_t STALL_INTERVALS = 5;    /**< Update intervals without a measurement after which the sensor counts as stalled. */
+    static const uint8_t DEFAULT_ADDRESS = 0x29; /**< I²C address of the sensor after power-up or an XSHUT reset. */
+    static const uint32_t SHOT_MARGIN_MS = 4;    /**< Time a single measurement may take beyond its timing budget. */
+    static const uint32_t TRACKER_GAP_SCANS = 3; /**< Scans of a region without a valid measurement after which its motion estimate restarts. */
+
+    /**
+     * @brief Steps of the asynchronous sensor read, each a single short I²C transfer.
+     */
+    enum ReadPhase : uint8_t {
+        ReadIdle,       /**< No read in progress. */
+        ReadStatus,     /**< Read range status and stream count. */
+        ReadSpads,      /**< Read the effective SPAD count. */
+        ReadAmbient,    /**< Read the ambient rate. */
+        ReadRange,      /**< Read the range and the signal rate. */
+        WriteDss,       /**< Write the SPAD target for the next measurement. */
+        ProgramRoi,     /**< Program the next region of interest of the scan. */
+        ClearInterrupt  /**< Clear the interrupt, which starts the next measurement. */
+    };
+
+    /**
+     * @brief Steps of a recovery attempt, each returning to update() without waiting.
+     */
+    enum RecoveryPhase : uint8_t {
+        RecoverWait,    /**< Wait out the backoff, then start the attempt. */
+        RecoverRelease, /**< XSHUT is held low; release it to boot the sensor. */
+        RecoverProbe,   /**< Wait for the sensor to answer. */
+        RecoverInit     /**< Re-initialize the driver and restore the settings. */
+    };
+
+    /**
+     * @brief Result registers collected by the asynchronous read.
+     */
+    struct PendingRead {
+        ReadPhase phase;       /**< Next step; ReadIdle if no read is in progress. */
+        uint8_t range_status;  /**< Raw RESULT__RANGE_STATUS register. */
+        uint8_t stream_count;  /**< Raw RESULT__STREAM_COUNT register. */
+        uint8_t roi;           /**< Region of interest of the result. */
+        uint16_t spads;        /**< Effective SPAD count, 8.8 fixed point. */
+        uint16_t ambient_rate; /**< Ambient rate, 9.7 fixed point MCPS. */
+        uint16_t range;        /**< Crosstalk-corrected range before the gain correction. */
+        uint16_t peak_rate;    /**< Crosstalk-corrected peak signal rate, 9.7 fixed point MCPS. */
+        uint32_t timestamp;    /**< Time the result was found ready. */
+    };
+
+    /**
+     * @brief State of a passage counter following an object along an ordered path of zones.
+     */
+    struct PassageCounter {
+        uint16_t zones[MAX_PASSAGE_ZONES]; /**< Zone indices along the path, in the "in" direction. */
+        uint8_t zone_count;                /**< Number of zones in the path; 0 if the counter is unused. */
+        uint8_t occupied;                  /**< Bit p set while zones[p] has an object present. */
+        uint8_t progress;                  /**< Number of path zones entered in order by the current passage. */
+        int8_t direction;                  /**< +1 or -1 for a passage in progress, 0 if idle. */
+        uint32_t timeout_ms;               /**< Longest time between transitions of one passage. */
+        uint32_t last_time;                /**< Timestamp of the last transition of the current passage. */
+        uint32_t in_count;                 /**< Completed passages from the first zone to the last. */
+        uint32_t out_count;                /**< Completed passages from the last zone to the first. */
+        PassageCallback on_passage;        /**< Called for every completed passage. */
+    };
+
+    /**
+     * @brief Aggregate occupancy of a zone group, kept up to date by zone transitions.
+     */
+    struct ZoneGroup {
+        bool used;                    /**< Whether the group is in use. */
+        uint16_t occupied;            /**< Number of member zones with an object present. */
+        size_t nearest;               /**< Occupied member with the lowest minimum distance, or INVALID_ZONE. */
+        size_t reported;              /**< Nearest occupied member at the last reported change, or INVALID_ZONE. */
+        ZoneGroupCallback on_change;  /**< Called once per update() in which the aggregate changed. */
+    };
+
+    VL53L1X sensor;                  /**< Instance of the VL53L1X sensor. */
+    uint32_t update_interval_ms;     /**< Interval for continuous measurements in milliseconds. */
+    uint32_t current_interval_ms;    /**< Interval the sensor is currently running at; longer while sampling is idle. */
+    uint32_t last_update_time;       /**< Timestamp of the last measurement update. */
+    size_t certainty_factor;         /**< Number of consecutive measurements required for stability. */
+    uint8_t interrupt_pin;           /**< MCU pin wired to the sensor's GPIO1, or NO_INTERRUPT_PIN. */
+    volatile bool data_ready_flag;   /**< Set by the GPIO1 interrupt when a measurement is ready. */
+    bool index_dirty;                /**< Set when zones change and the index must be rebuilt. */
+    bool zones_moved;                /**< Set when a delete moved zones to lower indices while a sample is evaluated. */
+    bool index_valid;                /**< False if the index did not fit its buffers; zones are then scanned linearly. */
+    VL53L1XSample last_sample;       /**< Most recent measurement, shared by the zones and the application. */
+    ZoneEventQueue *event_queue;     /**< Queue receiving zone transitions instead of inline callbacks, or nullptr. */
+    uint8_t next_generation;         /**< Generation given to the next zone that is added. */
+    VL53L1XSampleSource *sample_source; /**< Supplier of measurements and time replacing the sensor, or nullptr. */
+#if VL53L1XZONEMONITOR_ENABLE_SAMPLE_LOG
+    VL53L1XSampleLog *sample_log;    /**< Log receiving every raw measurement, or nullptr. */
+#endif
+    uint32_t accepted_statuses;      /**< Bit n set if VL53L1X::RangeStatus n passes the sample filter. */
+    float min_signal_rate;           /**< Minimum peak signal rate in MCPS passing the sample filter; 0 disables. */
+    float max_ambient_rate;          /**< Maximum ambient rate in MCPS passing the sample filter; 0 disables. */
+    uint8_t min_confidence;          /**< Minimum confidence passing the sample filter; 0 disables. */
+#if VL53L1XZONEMONITOR_ENABLE_PREFILTER
+    VL53L1XDistanceFilter prefilters[MAX_ROIS]; /**< Smoothing applied to accepted distances, one per region of interest. */
+#endif
+    VL53L1XRoi rois[MAX_ROIS];       /**< Regions of interest scanned in turn. */
+    uint8_t roi_count;               /**< Number of entries in rois; 0 uses the full field of view. */
+    uint8_t roi_position;            /**< Region of interest the measurement in progress was programmed with. */
+    bool settling;                   /**< Set when the sensor settings or the scan changed; the measurement in progress used the old ones. */
+#if VL53L1XZONEMONITOR_ENABLE_MOTION
+    VL53L1XMotionTracker trackers[MAX_ROIS]; /**< Velocity estimate of each region of interest. */
+    bool motion_tracking;            /**< Whether valid measurements update the trackers. */
+    uint16_t approach_lead_ms;       /**< Lead time of approach events in milliseconds; 0 disables them. */
+#endif
+#if VL53L1XZONEMONITOR_ENABLE_BACKGROUND
+    VL53L1XBackgroundModel backgrounds[MAX_ROIS]; /**< Static scene of each region of interest. */
+    bool background_suppression;     /**< Whether measurements matching the background count as no object. */
+#endif
+#if VL53L1XZONEMONITOR_MAX_COUNTERS > 0
+    PassageCounter counters[MAX_COUNTERS]; /**< Passage counters fed by zone transitions. */
+    uint8_t counter_count;           /**< Number of counters below which counters may be in use. */
+#endif
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+    ZoneGroup groups[MAX_GROUPS];    /**< Zone groups fed by zone transitions. */
+    uint8_t group_count;             /**< Number of groups below which groups may be in use. */
+    uint8_t group_changes;           /**< Bit g set if group g changed since its last report. */
+#endif
+    VL53L1XBusLock *bus_lock;        /**< Lock taken around sensor accesses, or nullptr. */
+    uint32_t bus_wait_ms;            /**< Longest wait for the bus lock before update() skips the sensor. */
+    uint32_t bus_budget_us;          /**< Bus time an update() may spend on asynchronous read steps; 0 for one step. */
+    uint8_t bus_lock_depth;          /**< Nesting depth of BusGuard objects holding bus_lock. */
+    bool async_read;                 /**< Read results in steps spread over several update() calls. */
+    bool driver_calibrated;          /**< False until the driver's own read() has run once since ranging started. */
+    PendingRead pending_read;        /**< State of the asynchronous read in progress. */
+    uint8_t config_depth;            /**< Nesting depth of open configuration transactions. */
+    bool driver_initialized;         /**< False after a warm start or a fault, until the driver runs its initialization again. */
+    uint8_t restored_distance_mode;  /**< VL53L1X::DistanceMode applied when the driver is initialized again. */
+    uint32_t timing_budget_us;       /**< Timing budget in effect; applied again when the driver is initialized. */
+    uint32_t idle_interval_ms;       /**< Measurement interval while all zones are empty; 0 disables adaptive sampling. */
+    uint32_t idle_budget_us;         /**< Timing budget while all zones are empty. */
+    uint32_t active_budget_us;       /**< Timing budget restored when activity is detected. */
+    uint32_t activity_hold_ms;       /**< Time without activity before falling back to idle sampling. */
+    uint32_t last_activity_time;     /**< Timestamp of the last sample with any in-zone activity. */
+    bool idle_sampling;              /**< True while the sensor runs at the idle interval and budget. */
+    bool ranging;                    /**< Whether continuous ranging should be running. */
+#if VL53L1XZONEMONITOR_ENABLE_FAULT_RECOVERY
+    bool fault_recovery;             /**< Whether faults are detected and trigger a re-initialization. */
+    Health health;                   /**< Current health state. */
+    Health reported_health;          /**< Health state last passed to the health callback. */
+    bool unknown_zones_pending;      /**< Set when a recovery started and the zones must still report their unknown state. */
+    UnknownZonePolicy unknown_policy; /**< State zones report while recovering. */
+    uint8_t shutdown_pin;            /**< MCU pin wired to the sensor's XSHUT input, or NO_SHUTDOWN_PIN. */
+    uint8_t max_faults;              /**< Consecutive faulty reads that start a recovery. */
+    uint8_t fault_count;             /**< Consecutive faulty reads so far. */
+    RecoveryPhase recovery_phase;    /**< Next step of the recovery in progress. */
+    uint8_t recovery_address;        /**< I²C address restored after an XSHUT reset. */
+    uint32_t recovery_time;          /**< Start of the current recovery step. */
+    uint32_t recovery_delay_ms;      /**< Backoff before the next recovery attempt. */
+    uint32_t max_backoff_ms;         /**< Upper limit of the backoff. */
+#endif
+    uint32_t last_read_time;         /**< Time the last measurement was read or ranging was started. */
+    bool single_shot;                /**< Whether each measurement is triggered by update() instead of ranging continuously. */
+#if VL53L1XZONEMONITOR_ENABLE_SINGLE_SHOT
+    bool shot_pending;               /**< Set while a triggered single measurement has not been read. */
+    uint32_t shot_time;              /**< Time the last single measurement was triggered. */
+    uint32_t next_shot_time;         /**< Time the next single measurement is due. */
+#endif
+#if VL53L1XZONEMONITOR_ENABLE_FAULT_RECOVERY
+#endif
+    HealthCallback on_health_change; /**< Called when the health state changes, or empty. */
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+    VL53L1XMonitorStats stats;       /**< Hot-path statistics. */
+#endif
+#if defined(ESP32)
+    TaskHandle_t acquisition_task;   /**< Background task reading the sensor, or nullptr. */
+    SemaphoreHandle_t state_mutex;   /**< Recursive mutex guarding the sensor and zones while the task runs. */
+    SemaphoreHandle_t config_mutex;  /**< state_mutex as taken by the outermost beginConfig(), or nullptr. */
+
+    /**
+     * @brief Body of the background acquisition task.
      *
-     * @param min Minimum distance for the zone in millimeters.
-     * @param max Maximum distance for the zone in millimeters.
-     * @param onEnter Callback function to execute when an object enters the zone.
-     * @param onExit Callback function to execute when an object exits the zone.
+     * @param monitor The monitor, passed as the task parameter.
      */
-    void addZone(uint16_t min, uint16_t max, std::function<void(uint16_t)> onEnter = nullptr, std::function<void()> onExit = nullptr);
+    static void acquisitionTaskMain(void *monitor);
+#endif
 
     /**
-     * @brief Updates an existing monitoring zone.
+     * @brief Holds the state mutex while background acquisition is running.
      *
-     * Allows modification of the minimum and maximum distance for an existing zone.
-     * If a parameter is not provided, the existing value remains unchanged.
+     * Does nothing on platforms without FreeRTOS or before startTask().
+     */
+    class StateLock {
+    public:
+        explicit StateLock(const VL53L1XZoneMonitorBase &monitor);
+        ~StateLock();
+        StateLock(const StateLock &) = delete;
+        StateLock &operator=(const StateLock &) = delete;
+
+    private:
+#if defined(ESP32)
+        SemaphoreHandle_t mutex; /**< Mutex taken by this lock, or nullptr. */
+#endif
+    };
+
+    /**
+     * @brief Holds the bus lock, if one is set, for the lifetime of the guard.
      *
-     * @param zone_index The index of the zone to update.
-     * @param min_distance Optional new minimum distance in millimeters.
-     * @param max_distance Optional new maximum distance in millimeters.
+     * Nested guards of the same monitor take the lock only once.
      */
-    void updateZone(size_t zone_index, uint16_t min_distance = 0, uint16_t max_distance = 0);
+    class BusGuard {
+    public:
+        BusGuard(VL53L1XZoneMonitorBase &monitor, uint32_t timeout_ms);
+        ~BusGuard();
+        BusGuard(const BusGuard &) = delete;
+        BusGuard &operator=(const BusGuard &) = delete;
+
+        /**
+         * @brief Checks whether the bus may be used.
+         *
+         * @return True if the lock is held or no bus lock is set.
+         */
+        bool isHeld() const;
+
+    private:
+        VL53L1XZoneMonitorBase &owner; /**< Monitor whose lock is held. */
+        VL53L1XBusLock *lock;          /**< Lock taken by this guard, or nullptr. */
+        bool held;                     /**< Whether the bus may be used. */
+    };
+
+    friend class ZoneView;
+
+    static VL53L1XZoneMonitorBase *volatile interrupt_owners[MAX_INTERRUPT_MONITORS]; /**< Monitors bound to each ISR slot. */
 
     /**
-     * @brief Checks if an object is present in a specific zone.
+     * @brief Attaches the GPIO1 data-ready interrupt for this monitor.
      *
-     * @param zone_index The index of the zone to check.
-     * @return True if an object is present, false otherwise.
+     * @return True if a free ISR slot was found and the pin supports interrupts.
+     */
+    bool attachDataReadyInterrupt();
+
+    /**
+     * @brief Detaches the GPIO1 interrupt and releases the ISR slot.
      */
-    bool isObjectInZone(size_t zone_index);
+    void detachDataReadyInterrupt();
 
     /**
-     * @brief Gets the total number of defined zones.
+     * @brief Uses GPIO1 data-ready interrupts on a pin if one is given.
      *
-     * @return The number of zones.
+     * @param pin MCU pin connected to GPIO1, or NO_INTERRUPT_PIN to poll.
+     * @return True unless attaching the interrupt failed.
      */
-    size_t getZoneCount() const;
+    bool useInterruptPin(uint8_t pin);
 
     /**
-     * @brief Gets a pointer to a specific zone.
+     * @brief Interrupt service routine shared by all ISR slots; only sets the data-ready flag.
      *
-     * @param zone_index The index of the zone to retrieve.
-     * @return Pointer to the ZoneObserver object, or nullptr if the index is invalid.
+     * @param slot Index into interrupt_owners.
      */
-    ZoneObserver *getZone(size_t zone_index);
+    static void handleDataReadyInterrupt(uint8_t slot);
 
     /**
-     * @brief Deletes a specific zone.
+     * @brief Argument-less ISR bound to one slot, as required by attachInterrupt().
+     */
+    template <uint8_t Slot>
+    static void dataReadyTrampoline();
+
+    /**
+     * @brief Rebuilds the interval index and the active zone list from the zone slots.
+     */
+    void rebuildZoneIndex();
+
+    /**
+     * @brief Checks whether a zone slot holds a zone.
      *
-     * @param zone_index The index of the zone to delete.
+     * @param zone_index The index of the slot.
+     * @return True if the slot is in range and not deleted.
      */
-    void deleteZone(size_t zone_index);
+    bool isZoneSlotUsed(size_t zone_index) const;
 
     /**
-     * @brief Gets the current distance measured by the sensor.
+     * @brief Checks whether a queued event still belongs to the zone, group or counter it was recorded for.
      *
-     * @return The measured distance in millimeters, or 0 if no valid data is available.
+     * @param event The event.
+     * @return True if the group or counter is in use, or the slot is in use and holds the zone the event was recorded for.
      */
-    uint16_t getDistance();
+    bool isQueuedEventLive(const ZoneEvent &event) const;
 
     /**
-     * @brief Sets the certainty factor for measurements.
+     * @brief Evaluates a measurement against every zone whose state can change.
      *
-     * The certainty factor defines the number of consecutive measurements required
-     * to confirm an object's presence or absence.
+     * Zones that neither cover the distance nor hold any state would only
+     * count another out-of-zone sample, which cannot trigger a callback, so
+     * they are skipped. Visited zones are evaluated in index order, keeping
+     * the callback order identical to evaluating every zone.
      *
-     * @param certainty The number of consecutive measurements required.
+     * @param distance Distance measured by the sensor in millimeters.
+     * @param roi Region of interest of the measurement; zones of other regions are left untouched.
+     * @return True if any zone has an object present or a pending in-zone count afterwards.
      */
-    void setCertaintyFactor(size_t certainty);
+    bool evaluateZones(uint16_t distance, uint8_t roi);
 
+#if VL53L1XZONEMONITOR_ENABLE_BACKGROUND
     /**
-     * @brief Gets the current certainty factor for measurements.
+     * @brief Evaluates a measurement of the learned background as no object for the zones of its region.
      *
-     * @return The number of consecutive measurements required.
+     * Only zones with an object present or a pending in-zone count can
+     * change, so only active_zones is visited.
+     *
+     * @param distance Distance measured by the sensor in millimeters, passed to exit events.
+     * @param roi Region of interest of the measurement.
+     * @return True if any zone has an object present or a pending in-zone count afterwards.
      */
-    size_t getCertaintyFactor() const;
+    bool evaluateBackground(uint16_t distance, uint8_t roi);
+#endif
 
     /**
-     * @brief Updates the sensor measurements and evaluates all zones.
+     * @brief Checks that a timing budget fits into a measurement period.
+     *
+     * @param budget_us Timing budget in microseconds.
+     * @param interval_ms Inter-measurement period in milliseconds.
+     * @return True if the period is not 0 and the budget does not exceed it.
+     */
+    static bool fitsInterval(uint32_t budget_us, uint32_t interval_ms);
+
+    /**
+     * @brief Stops ranging, applies distance mode, timing budget and interval together, and restarts.
+     *
+     * The first measurement after the restart is discarded. If the driver
+     * rejects a setting, the previous settings are kept.
+     *
+     * @param mode Distance mode.
+     * @param interval_ms Inter-measurement period in milliseconds.
+     * @param budget_us Timing budget in microseconds, at most the period.
+     * @return True if the settings were applied.
+     */
+    bool applySamplingProfile(VL53L1X::DistanceMode mode, uint32_t interval_ms, uint32_t budget_us);
+
+    /**
+     * @brief Switches between idle and fast sampling after a measurement.
+     *
+     * @param activity True if any zone saw the object in the last measurement.
+     * @param now Timestamp of the measurement.
+     */
+    void updateSamplingProfile(bool activity, uint32_t now);
+
+    /**
+     * @brief Queues a transition or, without an event queue, calls the zone's callback.
+     *
+     * @param zone_index The slot of the zone.
+     * @param type Kind of transition.
+     * @param distance Distance of the measurement that caused the transition.
+     * @param eta_ms Predicted time until entry for ZoneEvent::Approach.
+     * @param measured False for the transitions of the unknown zone policy,
+     *        which must not advance the passage counters.
+     */
+    void emitZoneEvent(size_t zone_index, ZoneEvent::Type type, uint16_t distance, uint16_t eta_ms = 0, bool measured = true);
+
+#if VL53L1XZONEMONITOR_ENABLE_MOTION
+    /**
+     * @brief Emits approach events for zones the tracked object will enter within the lead time.
+     *
+     * Visits every zone of the region, so it costs O(zones) per measurement
+     * while approach events are enabled.
+     *
+     * @param distance Distance of the measurement.
+     * @param roi Region of interest of the measurement.
      */
-    void update();
+    void predictZoneEntries(uint16_t distance, uint8_t roi);
+#endif
+
+#if VL53L1XZONEMONITOR_MAX_COUNTERS > 0
+    /**
+     * @brief Advances the passage counters whose path contains a zone.
+     *
+     * Costs at most MAX_COUNTERS * MAX_PASSAGE_ZONES comparisons per transition.
+     *
+     * @param zone_index The slot of the zone.
+     * @param entered True for an enter transition, false for an exit.
+     */
+    void updatePassageCounters(size_t zone_index, bool entered);
+
+    /**
+     * @brief Abandons the passages in progress and forgets which path zones are occupied.
+     *
+     * Called when a recovery starts and ends, since the zone states in
+     * between do not stem from measurements.
+     */
+    void abandonPassages();
+
+    /**
+     * @brief Updates the passage counters after a zone was deleted.
+     *
+     * @param zone_index The slot of the deleted zone.
+     * @param shifted True if every later zone moved down by one index.
+     */
+    void releasePassageZone(size_t zone_index, bool shifted);
+#endif
+
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+    /**
+     * @brief Updates the groups a zone belongs to after a transition.
+     *
+     * Costs O(1) per group, except when the nearest occupied zone of a group
+     * exits, which rescans the zone slots.
+     *
+     * @param zone_index The slot of the zone.
+     * @param entered True for an enter transition, false for an exit.
+     */
+    void updateZoneGroups(size_t zone_index, bool entered);
+
+    /**
+     * @brief Recounts the occupied members of a group and finds its nearest one by scanning the zone slots.
+     *
+     * Marks the group changed if the nearest occupied zone differs from the
+     * one last reported.
+     *
+     * @param group The index of the group.
+     */
+    void refreshZoneGroup(uint8_t group);
+
+    /**
+     * @brief Recounts every group after zones were deleted or restored, without reporting a change.
+     */
+    void resyncZoneGroups();
+
+    /**
+     * @brief Calls the callbacks of the groups that changed since their last report.
+     */
+    void reportZoneGroups();
+#endif
+
+    /**
+     * @brief Checks the measurement just read from the sensor against the sample filter.
+     *
+     * @param from_sensor True if the sensor's ranging data belongs to the measurement,
+     *        false for measurements from a sample source, which carry no rates.
+     * @return True if the measurement may be evaluated.
+     */
+    bool passesSampleFilter(bool from_sensor) const;
+
+    /**
+     * @brief Rates the measurement just read.
+     *
+     * @param from_sensor True if the sensor's ranging data belongs to the measurement.
+     * @return The confidence from 0 to 255.
+     */
+    uint8_t measureConfidence(bool from_sensor) const;
+
+    /**
+     * @brief Programs the next region of interest of the scan.
+     *
+     * Called before a result is read, so the sensor already measures the
+     * next region while the current one is evaluated.
+     *
+     * @return The region of interest of the result about to be read.
+     */
+    uint8_t advanceRoiScan();
+
+    /**
+     * @brief Gets the current time from the sample source, or millis() without one.
+     *
+     * @return Time in milliseconds.
+     */
+    uint32_t currentTime() const;
+
+    /**
+     * @brief Calls the callback matching a transition.
+     *
+     * @param callbacks The callbacks of the zone, copied so the zone may be changed by the callback.
+     * @param zone_index The slot of the zone.
+     * @param type Kind of transition.
+     * @param distance Distance of the measurement that caused the transition.
+     * @param eta_ms Predicted time until entry for ZoneEvent::Approach.
+     */
+    void runZoneCallback(ZoneCallbacks callbacks, size_t zone_index, ZoneEvent::Type type, uint16_t distance,
+                         uint16_t eta_ms);
+
+    /**
+     * @brief Evaluates a measurement against one zone, as ZoneObserver::evaluate() does.
+     *
+     * @param zone_index The slot of the zone.
+     * @param distance Distance measured by the sensor in millimeters.
+     * @param certainty Monitor-wide number of consecutive measurements required, at most 255; overridden by the zone's own certainty.
+     */
+    void evaluateZone(size_t zone_index, uint16_t distance, uint8_t certainty);
+
+    /**
+     * @brief Counts an in-zone or out-of-zone measurement and emits the transition once certain.
+     *
+     * @param zone_index The slot of the zone.
+     * @param in_zone True if the measurement is inside the zone.
+     * @param distance Distance measured by the sensor in millimeters.
+     * @param certainty Monitor-wide number of consecutive measurements required, at most 255; overridden by the zone's own certainty.
+     */
+    void countZoneSample(size_t zone_index, bool in_zone, uint16_t distance, uint8_t certainty);
+
+    /**
+     * @brief Checks whether a zone holds state that an out-of-zone sample can change.
+     *
+     * @param zone_index The slot of the zone.
+     * @return True if an object is present or an in-zone count is pending.
+     */
+    bool isZoneActive(size_t zone_index) const;
+
+    /**
+     * @brief Runs the driver's full initialization if a warm start skipped it.
+     *
+     * The driver derives its oscillator calibration in init(); timing budget
+     * and interval changes are wrong without it. The restored configuration
+     * is reapplied afterwards.
+     *
+     * @return True if the driver is initialized.
+     */
+    bool ensureDriverInitialized();
+
+    /**
+     * @brief Validates a configuration blob.
+     *
+     * @param data The blob.
+     * @param size Size of the blob in bytes.
+     * @return True if the blob is complete, uncorrupted and of a supported version.
+     */
+    static bool isValidConfig(const uint8_t *data, size_t size);
+
+    /**
+     * @brief Applies the monitor and zone settings of a validated configuration blob.
+     *
+     * @param data The blob.
+     * @param to_sensor True to also write the sensor settings, skipping unchanged ones.
+     * @return True on success, false if the zone storage is too small.
+     */
+    bool applyConfig(const uint8_t *data, bool to_sensor);
+
+#if VL53L1XZONEMONITOR_ENABLE_FAULT_RECOVERY
+    /**
+     * @brief Records the outcome of a sensor access for fault recovery.
+     *
+     * @param faulty True if the access failed or returned invalid data.
+     * @param now Time of the access.
+     */
+    void recordSensorResult(bool faulty, uint32_t now);
+
+    /**
+     * @brief Starts recovering the sensor; the zones move to their unknown state in reportFaultState().
+     *
+     * @param now Time the fault was detected.
+     */
+    void startRecovery(uint32_t now);
+
+    /**
+     * @brief Performs the next step of the recovery in progress.
+     *
+     * @param now Current time.
+     */
+    void stepRecovery(uint32_t now);
+
+    /**
+     * @brief Schedules the next recovery attempt with a doubled backoff.
+     *
+     * @param now Time the attempt failed.
+     */
+    void failRecovery(uint32_t now);
+
+    /**
+     * @brief Changes the health state; reportFaultState() calls the health callback.
+     *
+     * @param state The new state.
+     */
+    void setHealth(Health state);
+#endif
+
+    /**
+     * @brief Checks whether the sensor has a new result, honouring the update interval.
+     *
+     * @return True if a result can be read.
+     */
+    bool isMeasurementReady();
+
+    /**
+     * @brief Performs the next step of the asynchronous read.
+     *
+     * @return True if the read is complete and last_sample holds the result.
+     */
+    bool stepAsyncRead();
+
+    /**
+     * @brief Resets the read state after ranging was (re)started.
+     */
+    void resetReadState();
+
+    /**
+     * @brief Performs a measurement update and evaluates all zones.
+     *
+     * This method reads the sensor data and updates the state of each zone,
+     * triggering callbacks if the certainty factor is met.
+     *
+     * @return True if a new measurement was read, false otherwise.
+     */
+    bool performUpdate();
+
+    /**
+     * @brief Reads the next measurement from the sensor while holding the bus, and tracks its faults.
+     *
+     * Health changes and the unknown zone state of a recovery are only
+     * recorded; reportFaultState() reports them once the bus is released.
+     *
+     * @return True if a new measurement was read, false otherwise.
+     */
+    bool readSensorSample();
+
+#if VL53L1XZONEMONITOR_ENABLE_FAULT_RECOVERY
+    /**
+     * @brief Reports the recorded health change and applies the unknown zone policy of a recovery that started.
+     *
+     * Must be called without holding the bus, since it runs callbacks.
+     */
+    void reportFaultState();
+#endif
+
+    /**
+     * @brief Reads the next measurement from the sample source or the sensor into last_sample.
+     *
+     * @return True if a new measurement was read, false otherwise.
+     */
+    bool readMeasurement();
+
+#if VL53L1XZONEMONITOR_ENABLE_SINGLE_SHOT
+    /**
+     * @brief Triggers the next single measurement once it is due.
+     *
+     * A triggered measurement whose result has not arrived an interval after
+     * its timing budget is taken as lost and triggered again.
+     *
+     * @return True while a triggered measurement awaits reading.
+     */
+    bool updateSingleShot();
+
+    /**
+     * @brief Switches the sensor between continuous and single-shot ranging.
+     *
+     * @param single True for single-shot ranging.
+     */
+    void applyRangingMode(bool single);
+#endif
+
+protected:
+    // Zone slots and interval index buffers, owned by the derived class.
+    // Zones are stored as parallel arrays so that evaluation only touches the
+    // bounds and the packed counters; callbacks live in a separate cold array.
+    // The interval index splits the distance axis at every zone boundary into
+    // segments that are covered by a fixed set of zones, so a sample only needs
+    // to visit the zones covering its segment plus the zones that currently
+    // hold state and can still change.
+    uint16_t *zone_min;             /**< Minimum distance of each zone slot in millimeters. */
+    uint16_t *zone_max;             /**< Maximum distance of each zone slot in millimeters. */
+    uint8_t *zone_in_count;         /**< Consecutive in-zone measurements of each slot, saturating. */
+    uint8_t *zone_out_count;        /**< Consecutive out-of-zone measurements of each slot, saturating. */
+    uint16_t *zone_hysteresis;      /**< Exit hysteresis margin of each slot in millimeters. */
+    uint8_t *zone_certainty;        /**< Certainty of each slot, or 0 for the monitor-wide certainty factor. */
+    uint8_t *zone_roi;              /**< Region of interest each slot is evaluated for. */
+    uint8_t *zone_present;          /**< Bitset of slots with an object present. */
+    uint8_t *zone_approaching;      /**< Bitset of slots whose approach event has fired since the object last entered or turned away. */
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+    uint8_t *zone_groups;           /**< Bit g set if the slot belongs to zone group g. */
+#endif
+    uint8_t *zone_generation;       /**< Generation of each slot, stamped into its queued events. */
+    const uint8_t *zone_used;       /**< Bitset of used slots, or nullptr if every slot below zone_slots is used. */
+    ZoneCallbacks *zone_callbacks;  /**< Callbacks of each zone slot. */
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+    VL53L1XTimingStats *zone_callback_us; /**< Callback timing of each zone slot. */
+#endif
+    size_t zone_slots;              /**< Number of slots in use, including deleted ones. */
+    uint16_t *index_bounds;     /**< Sorted start distance of each segment. */
+    uint16_t *index_offsets;    /**< Start of each segment's zones in index_members; one extra end entry. */
+    uint16_t *index_members;    /**< Zone indices covering each segment, ascending. */
+    uint16_t *active_zones;     /**< Zones with an object present or a pending in-zone count, ascending; zone_slots entries. */
+    uint16_t *candidate_zones;  /**< Scratch list of zones visited by the current sample; zone_slots entries. */
+    size_t index_bound_count;   /**< Number of segments in the index. */
+    size_t active_count;        /**< Number of entries in active_zones. */
+
+    /**
+     * @brief Constructs a VL53L1XZoneMonitorBase object without zone storage.
+     *
+     * @param wire Optional pointer to a TwoWire object for custom I²C bus.
+     * @param interval_ms Interval for continuous measurements in milliseconds.
+     * @param certainty Number of consecutive measurements required for stability.
+     */
+    VL53L1XZoneMonitorBase(TwoWire *wire, uint32_t interval_ms, size_t certainty);
+
+    /**
+     * @brief Provides a slot for a new zone.
+     *
+     * Must keep the zone arrays, zone_slots, active_zones and candidate_zones valid.
+     *
+     * @return The index of the slot, or INVALID_ZONE if storage is full.
+     */
+    virtual size_t allocateZoneSlot() = 0;
+
+    /**
+     * @brief Releases the slot of a deleted zone.
+     *
+     * @param zone_index The index of the slot.
+     * @param keep_indices True inside a configuration transaction; the slot
+     *        must then become reusable without moving any other zone.
+     * @return True if every later zone moved down by one index.
+     */
+    virtual bool releaseZoneSlot(size_t zone_index, bool keep_indices) = 0;
+
+    /**
+     * @brief Returns the largest number of zone slots the storage can hold.
+     */
+    virtual size_t getZoneCapacity() const = 0;
+
+    /**
+     * @brief Makes room for an interval index of the given size.
+     *
+     * Existing contents of the index buffers must be preserved, since the
+     * index is rebuilt in place and may grow while it is written.
+     *
+     * @param bound_count Number of segments; index_offsets needs one more entry.
+     * @param member_count Number of entries in index_members.
+     * @return True if the index fits, false to fall back to a linear scan.
+     */
+    virtual bool reserveZoneIndex(size_t bound_count, size_t member_count) = 0;
+
+    static bool testBit(const uint8_t *bits, size_t i) { return (bits[i >> 3] >> (i & 7)) & 1; }
+    static void setBit(uint8_t *bits, size_t i) { bits[i >> 3] |= (uint8_t)(1 << (i & 7)); }
+    static void clearBit(uint8_t *bits, size_t i) { bits[i >> 3] &= (uint8_t)~(1 << (i & 7)); }
+
+public:
+    VL53L1XZoneMonitorBase(const VL53L1XZoneMonitorBase &) = delete;
+    VL53L1XZoneMonitorBase &operator=(const VL53L1XZoneMonitorBase &) = delete;
+
+    /**
+     * @brief Detaches the GPIO1 interrupt, if one was attached in init().
+     */
+    virtual ~VL53L1XZoneMonitorBase();
+
+    /**
+     * @brief Initializes the VL53L1X sensor.
+     *
+     * When an interrupt pin is given, the sensor's GPIO1 output is used to signal
+     * data-ready and update() only touches the I²C bus once a measurement is
+     * actually available. Otherwise the sensor is polled over I²C.
+     *
+     * @param interrupt_pin Optional MCU pin connected to the sensor's GPIO1 output.
+     * @return True if initialization is successful, false otherwise.
+     */
+    bool init(uint8_t interrupt_pin = NO_INTERRUPT_PIN);
+
+    /**
+     * @brief Changes the I²C address of the sensor.
+     *
+     * Used when several sensors share a bus; see VL53L1XMonitorArray.
+     *
+     * @param address The new 7-bit I²C address.
+     */
+    void setAddress(uint8_t address);
+
+    /**
+     * @brief Gets the current I²C address of the sensor.
+     *
+     * @return The 7-bit I²C address.
+     */
+    uint8_t getAddress();
+
+    /**
+     * @brief Starts continuous ranging with the configured update interval.
+     *
+     * init() already starts ranging; this is only needed after stopRanging().
+     */
+    void startRanging();
+
+    /**
+     * @brief Stops continuous ranging.
+     */
+    void stopRanging();
+
+#if VL53L1XZONEMONITOR_ENABLE_SINGLE_SHOT
+    /**
+     * @brief Switches to single-shot ranging for duty-cycled operation.
+     *
+     * Instead of ranging continuously, the sensor idles between measurements
+     * and update() triggers one measurement per update interval, or per idle
+     * interval with adaptive sampling, and reads its result once GPIO1
+     * signals it or a poll finds it ready. Between the two the MCU may sleep
+     * until getNextWakeDelay() has passed or GPIO1 goes low. Combined with
+     * saveZoneState() and initFromConfig(), the monitor survives deep sleep;
+     * see the README for the wake cycle. stopRanging() and startRanging()
+     * pause and resume the triggers.
+     */
+    void enableSingleShot();
+
+    /**
+     * @brief Returns to continuous ranging.
+     */
+    void disableSingleShot();
+#endif
+
+    /**
+     * @brief Checks whether single-shot ranging is enabled.
+     *
+     * @return True if update() triggers each measurement.
+     */
+    bool isSingleShot() const;
+
+    /**
+     * @brief Gets the time until update() next has work to do.
+     *
+     * In single-shot mode this is the time until the next measurement is
+     * due, or while one is in progress until its result is expected; GPIO1
+     * may signal the result earlier. While ranging continuously it is the
+     * time until the next result, and while recovering the time until the
+     * next recovery step. An application sleeps for this long between calls
+     * to update().
+     *
+     * @return The time in milliseconds, 0 if update() is due now, or
+     *         UINT32_MAX while ranging is stopped.
+     */
+    uint32_t getNextWakeDelay() const;
+
+    /**
+     * @brief Sets the distance mode of the sensor.
+     *
+     * The distance mode determines the trade-off between range and ambient
+     * light resistance. Available modes are Short, Medium, and Long. Applied
+     * like reconfigure() with the current timing budget and interval.
+     *
+     * @param mode The desired distance mode.
+     * @return True on success, false if the driver rejected the mode.
+     */
+    bool setDistanceMode(VL53L1X::DistanceMode mode);
+
+    /**
+     * @brief Gets the current distance mode of the sensor.
+     *
+     * @return The current distance mode.
+     */
+    VL53L1X::DistanceMode getDistanceMode();
+
+    /**
+     * @brief Sets the measurement timing budget.
+     *
+     * The timing budget defines the time the sensor spends on a single measurement,
+     * affecting accuracy and measurement frequency. With adaptive sampling, this
+     * is the budget used while sampling fast. Applied like reconfigure() with
+     * the current distance mode and interval.
+     *
+     * @param budget_us The timing budget in microseconds.
+     * @return True on success, false if the budget exceeds the update interval or the driver rejected it.
+     */
+    bool setMeasurementTimingBudget(uint32_t budget_us);
+
+    /**
+     * @brief Changes distance mode, timing budget and update interval in one step.
+     *
+     * Changing these one at a time while the sensor ranges continuously
+     * leaves it running with a mixed configuration, or with a budget longer
+     * than the period. reconfigure() validates the combination, stops
+     * ranging, applies all three and restarts, without the full driver
+     * initialization, and discards the first measurement after the restart.
+     * If the driver rejects a setting, the previous settings stay in effect.
+     * With adaptive sampling, budget and interval are those used while
+     * sampling fast; while sampling is idle they take effect when it speeds
+     * up, and only the distance mode is applied at once.
+     *
+     * @param mode The distance mode.
+     * @param budget_us The timing budget in microseconds, at most the interval.
+     * @param interval_ms The inter-measurement period in milliseconds.
+     * @return True on success, false if the combination is invalid or was rejected.
+     */
+    bool reconfigure(VL53L1X::DistanceMode mode, uint32_t budget_us, uint32_t interval_ms);
+
+    /**
+     * @brief Enables adaptive sampling.
+     *
+     * While every zone is empty, the sensor runs at a long inter-measurement
+     * period and a low timing budget to save power. The first measurement
+     * inside any zone switches back to the update interval and the timing
+     * budget set with setMeasurementTimingBudget(), which are kept until no
+     * zone has seen the object for hold_ms.
+     *
+     * @param idle_interval_ms Inter-measurement period while idle in milliseconds.
+     * @param idle_budget_us Timing budget while idle in microseconds; must fit into the idle period.
+     * @param hold_ms Time without activity before returning to idle sampling in milliseconds.
+     * @return True if enabled, false if the parameters are invalid.
+     */
+    bool enableAdaptiveSampling(uint32_t idle_interval_ms, uint32_t idle_budget_us, uint32_t hold_ms);
+
+    /**
+     * @brief Disables adaptive sampling and restores the update interval and timing budget.
+     */
+    void disableAdaptiveSampling();
+
+    /**
+     * @brief Checks whether adaptive sampling is currently in its idle state.
+     *
+     * @return True while sampling at the idle interval, false otherwise.
+     */
+    bool isIdleSampling() const;
+
+#if VL53L1XZONEMONITOR_ENABLE_MOTION
+    /**
+     * @brief Tracks the radial velocity of the object and optionally predicts zone entries.
+     *
+     * An alpha-beta filter in fixed point follows the filtered distance of
+     * every valid measurement, separately for each region of interest. With
+     * a lead time, a zone's approach callback (or a ZoneEvent::Approach)
+     * fires once as soon as the object is predicted to reach the zone within
+     * that time, ahead of the enter callback that waits for the certainty
+     * factor. It fires again only after the object entered the zone or
+     * turned away.
+     *
+     * @param lead_ms Lead time of approach events in milliseconds; 0 only tracks the velocity.
+     * @param alpha Position gain in 1/256, from 1 to 255.
+     * @param beta Velocity gain in 1/256, from 1 to 255.
+     * @return True on success, false if a gain is 0.
+     */
+    bool enableMotionTracking(uint16_t lead_ms = 0, uint8_t alpha = 128, uint8_t beta = 32);
+
+    /**
+     * @brief Stops velocity tracking and approach events.
+     */
+    void disableMotionTracking();
+
+    /**
+     * @brief Gets the tracked radial velocity.
+     *
+     * @param roi Region of interest whose estimate to return.
+     * @return The velocity in millimeters per second, negative while the
+     *         object approaches the sensor; 0 without motion tracking.
+     */
+    int16_t getVelocity(uint8_t roi = 0) const;
+#endif
+
+#if VL53L1XZONEMONITOR_ENABLE_BACKGROUND
+    /**
+     * @brief Learns the static scene and keeps fixed reflectors out of the zones.
+     *
+     * Each region of interest keeps a running baseline of the filtered
+     * distance, learned from the first valid measurement and slowly adapted
+     * by the measurements that match it. A measurement within the tolerance
+     * of the baseline counts as no object, so a shelf or door frame inside a
+     * zone never enters it, and an object in front of it exits as soon as it
+     * leaves. Enable it while the scene is empty, or call relearnBackground()
+     * once it is. With an absorb time, a change that stays put that long,
+     * such as a moved box, becomes the new background.
+     *
+     * @param tolerance_mm Largest difference from the baseline that matches it, in millimeters.
+     * @param absorb_ms Time a steady change takes to become background in milliseconds; 0 never.
+     * @param adapt_shift Adaptation weight exponent from 1 to 8; each matching measurement weighs 1/2^adapt_shift.
+     * @return True on success, false if a parameter is out of range.
+     */
+    bool enableBackgroundSuppression(uint16_t tolerance_mm, uint32_t absorb_ms = 0, uint8_t adapt_shift = 6);
+
+    /**
+     * @brief Stops suppressing the background; every measurement is evaluated again.
+     */
+    void disableBackgroundSuppression();
+
+    /**
+     * @brief Forgets the learned background; the next measurement of each region is learned as its baseline.
+     */
+    void relearnBackground();
+
+    /**
+     * @brief Gets the learned background distance.
+     *
+     * @param roi Region of interest whose baseline to return.
+     * @return The baseline in millimeters, or 0 if none has been learned or suppression is off.
+     */
+    uint16_t getBackgroundDistance(uint8_t roi = 0) const;
+#endif
+
+    /**
+     * @brief Gets the current measurement timing budget.
+     *
+     * @return The timing budget in microseconds.
+     */
+    uint32_t getMeasurementTimingBudget();
+
+#if VL53L1XZONEMONITOR_ENABLE_FAULT_RECOVERY
+    /**
+     * @brief Detects a failing sensor and re-initializes it without blocking update().
+     *
+     * A read failing on the bus, or returning a HardwareFail or no range
+     * status, counts as a fault and is not evaluated; max_faults faults in
+     * a row, or no measurement for five update intervals while ranging,
+     * start a recovery. The sensor is then reset through XSHUT if a pin is
+     * given, or by the driver's software reset otherwise, and re-initialized
+     * with its address, distance mode, timing budget, interval and ROI. Each
+     * update() performs at most one step and returns, so the loop keeps
+     * running; only the final re-initialization takes a few milliseconds.
+     * Failed attempts are retried after 100 ms, doubling up to
+     * max_backoff_ms. Set a timeout with setTimeout() so the driver cannot
+     * block on a sensor failing during re-initialization.
+     *
+     * After an XSHUT reset the sensor answers at 0x29 until its address is
+     * restored, so no other device may use that address.
+     *
+     * @param xshut_pin MCU pin connected to the sensor's XSHUT input, or NO_SHUTDOWN_PIN.
+     * @param faults Consecutive faulty reads that start a recovery, at least 1.
+     * @param backoff_ms Longest wait between recovery attempts in milliseconds.
+     * @return True on success, false if faults is 0.
+     */
+    bool enableFaultRecovery(uint8_t xshut_pin = NO_SHUTDOWN_PIN, uint8_t faults = 3, uint32_t backoff_ms = 10000);
+
+    /**
+     * @brief Stops fault detection; a recovery in progress is abandoned.
+     */
+    void disableFaultRecovery();
+#endif
+
+    /**
+     * @brief Gets the health state of the sensor.
+     *
+     * @return Healthy unless fault recovery has seen recent faults.
+     */
+    Health getHealth() const;
+
+#if VL53L1XZONEMONITOR_ENABLE_FAULT_RECOVERY
+    /**
+     * @brief Selects the state zones report while the sensor is recovering.
+     *
+     * When a recovery starts, pending in-zone and out-of-zone counts are
+     * cleared and the zones move to the selected state, firing their enter
+     * or exit callbacks with a distance of 0. After the recovery the zones
+     * are evaluated again from that state. ZoneView::isKnown() is false in
+     * between. The default is KeepLastState.
+     *
+     * @param policy The state zones report.
+     */
+    void setUnknownZonePolicy(UnknownZonePolicy policy);
+
+    /**
+     * @brief Sets the callback for changes of the health state.
+     *
+     * Runs inside update(), or in the background task on ESP32.
+     *
+     * @param onHealthChange Callback receiving the new state.
+     */
+    void setHealthCallback(HealthCallback onHealthChange);
+#endif
+
+    /**
+     * @brief Sets the timeout for sensor operations.
+     *
+     * @param timeout Timeout duration in milliseconds.
+     */
+    void setTimeout(uint16_t timeout);
+
+    /**
+     * @brief Gets the current timeout duration.
+     *
+     * @return Timeout duration in milliseconds.
+     */
+    uint16_t getTimeout();
+
+    /**
+     * @brief Stores the sensor settings and the zone table in a compact binary blob.
+     *
+     * The blob holds the address, distance mode, timing budget, interval,
+     * timeout, certainty factor, sample filter, prefilter, ROI scan, adaptive
+     * sampling settings, ranging mode and all zones with their indices, protected by a
+     * checksum. Callbacks, the interrupt pin, the event queue and the sample
+     * source are not stored. Write it to EEPROM, NVS or RTC memory.
+     *
+     * @param buffer Buffer receiving the blob, or nullptr to query the size.
+     * @param buffer_size Size of the buffer in bytes.
+     * @return The size of the blob, or 0 if the buffer is too small.
+     */
+    size_t saveConfig(uint8_t *buffer, size_t buffer_size);
+
+    /**
+     * @brief Restores the settings and zones of a blob written by saveConfig().
+     *
+     * Call it after init(). Only settings that differ from the sensor's
+     * current ones are written. Existing zones are replaced and restored
+     * zones keep their saved indices; their callbacks must be set again
+     * with setZoneCallbacks(). The whole blob is checked first; if it is
+     * rejected, or the sensor refuses its sampling profile, the settings and
+     * zones are left unchanged.
+     *
+     * @param data The blob.
+     * @param size Size of the blob in bytes.
+     * @return True on success, false if the blob is invalid, the zones do not
+     *         fit or the sensor refused the sampling profile.
+     */
+    bool restoreConfig(const uint8_t *data, size_t size);
+
+    /**
+     * @brief Initializes the monitor from a blob, skipping the sensor initialization on a warm boot.
+     *
+     * Use it in place of init() when waking from deep sleep while the sensor
+     * kept its power and kept ranging. If the sensor answers at the default
+     * address, only the monitor state is restored and no register is written,
+     * so the first detection follows within one measurement. Otherwise, for
+     * example after a power loss or for a blob with a changed address, the
+     * full init() and restoreConfig() run instead. The driver's own
+     * initialization is then deferred until a setting needing its calibration,
+     * such as the timing budget or the interval, is changed.
+     *
+     * @param data The blob.
+     * @param size Size of the blob in bytes.
+     * @param interrupt_pin Optional MCU pin connected to the sensor's GPIO1 output.
+     * @return True if the monitor is ready, false if the blob is invalid or initialization failed.
+     */
+    bool initFromConfig(const uint8_t *data, size_t size, uint8_t interrupt_pin = NO_INTERRUPT_PIN);
+
+    /**
+     * @brief Stores the zone state in a compact blob that survives deep sleep.
+     *
+     * The blob holds the in-zone and out-of-zone counts and the presence of
+     * every zone slot, the passages counted and in progress of every
+     * counter, whether adaptive sampling is idle and whether a single
+     * measurement is in progress: about two bytes per zone plus ten per
+     * counter and nine bytes of header and checksum. Size it for RTC memory, which keeps its contents
+     * while an ESP32 sleeps. Zones, settings and callbacks are not included;
+     * store them with saveConfig().
+     *
+     * @param buffer Buffer receiving the blob, or nullptr to query the size.
+     * @param buffer_size Size of the buffer in bytes.
+     * @return The size of the blob, or 0 if the buffer is too small.
+     */
+    size_t saveZoneState(uint8_t *buffer, size_t buffer_size) const;
+
+    /**
+     * @brief Restores the zone state of a blob written by saveZoneState().
+     *
+     * Call it after initFromConfig() and after adding the passage counters,
+     * so the zone slots and counters match those at the time of saving. No
+     * zone events are emitted; zones and passages resume where they were,
+     * with the passage timeout restarted. The time spent asleep counts as
+     * elapsed, so a single measurement that was in progress is read at the
+     * next update(), and otherwise the next one is due at once.
+     *
+     * @param data The blob.
+     * @param size Size of the blob in bytes.
+     * @return True on success, false if the blob is invalid or does not match the zones.
+     */
+    bool restoreZoneState(const uint8_t *data, size_t size);
+
+    /**
+     * @brief Adds a new monitoring zone.
+     *
+     * Each zone is defined by a minimum and maximum distance, with optional
+     * callbacks for entering and exiting events.
+     *
+     * @param min Minimum distance for the zone in millimeters.
+     * @param max Maximum distance for the zone in millimeters.
+     * @param onEnter Callback function to execute when an object enters the zone.
+     * @param onExit Callback function to execute when an object exits the zone.
+     * @return The index of the new zone, or INVALID_ZONE if the zone storage is full.
+     */
+    size_t addZone(uint16_t min, uint16_t max, ZoneEnterCallback onEnter = nullptr, ZoneExitCallback onExit = nullptr);
+
+    /**
+     * @brief Adds a new monitoring zone with context-pointer callbacks.
+     *
+     * Both callbacks receive the same context pointer as their first argument,
+     * which allows member functions or shared state to be reached without
+     * capturing lambdas.
+     *
+     * @param min Minimum distance for the zone in millimeters.
+     * @param max Maximum distance for the zone in millimeters.
+     * @param onEnter Function to execute when an object enters the zone, or nullptr.
+     * @param onExit Function to execute when an object exits the zone, or nullptr.
+     * @param context Pointer passed to both functions.
+     * @return The index of the new zone, or INVALID_ZONE if the zone storage is full.
+     */
+    size_t addZone(uint16_t min, uint16_t max, void (*onEnter)(void *context, uint16_t distance), void (*onExit)(void *context),
+                 void *context);
+
+    /**
+     * @brief Updates an existing monitoring zone.
+     *
+     * Allows modification of the minimum and maximum distance for an existing zone.
+     * If a parameter is not provided, the existing value remains unchanged.
+     *
+     * @param zone_index The index of the zone to update.
+     * @param min_distance Optional new minimum distance in millimeters.
+     * @param max_distance Optional new maximum distance in millimeters.
+     */
+    void updateZone(size_t zone_index, uint16_t min_distance = 0, uint16_t max_distance = 0);
+
+    /**
+     * @brief Sets both bounds of an existing zone.
+     *
+     * Unlike updateZone(), 0 is a valid bound.
+     *
+     * @param zone_index The index of the zone to update.
+     * @param min_distance New minimum distance in millimeters.
+     * @param max_distance New maximum distance in millimeters.
+     * @return True on success, false if the zone does not exist.
+     */
+    bool setZoneBounds(size_t zone_index, uint16_t min_distance, uint16_t max_distance);
+
+    /**
+     * @brief Starts a configuration transaction.
+     *
+     * Until the matching commit(), zone changes are applied to the stored
+     * zones but no measurement is evaluated, so the zones are never seen
+     * half-configured. Deleted zones keep their slot, which the next added
+     * zone reuses, so zone indices stay stable and replacing a zone set
+     * does not reallocate. On ESP32 the background task is held off for the
+     * whole transaction. Transactions may be nested.
+     */
+    void beginConfig();
+
+    /**
+     * @brief Ends a configuration transaction.
+     *
+     * The outermost commit() rebuilds the zone index once for all changes.
+     *
+     * @return True on success, false if no transaction was open.
+     */
+    bool commit();
+
+    /**
+     * @brief Checks whether a configuration transaction is open.
+     *
+     * @return True between beginConfig() and the matching commit().
+     */
+    bool isConfiguring() const;
+
+    /**
+     * @brief Sets the exit hysteresis of a zone.
+     *
+     * An object enters the zone inside [min, max] but is only counted as
+     * having left it outside [min - hysteresis, max + hysteresis], so an
+     * object resting on a boundary no longer toggles the zone.
+     *
+     * @param zone_index The index of the zone.
+     * @param hysteresis Margin in millimeters; 0 disables hysteresis.
+     * @return True on success, false if the zone does not exist.
+     */
+    bool setZoneHysteresis(size_t zone_index, uint16_t hysteresis);
+
+    /**
+     * @brief Sets the certainty factor of a single zone.
+     *
+     * Overrides the monitor-wide certainty factor, so that fast zones can react
+     * to a single measurement while noisy zones wait for several.
+     *
+     * @param zone_index The index of the zone.
+     * @param certainty Consecutive measurements required, or 0 to use the monitor's certainty factor.
+     * @return True on success, false if the zone does not exist.
+     */
+    bool setZoneCertainty(size_t zone_index, uint8_t certainty);
+
+    /**
+     * @brief Attaches a zone to a region of interest of the ROI scan.
+     *
+     * The zone is only evaluated with measurements of that region. Zones
+     * belong to region 0 when added.
+     *
+     * @param zone_index The index of the zone.
+     * @param roi Index into the list passed to setRoiScan(), below MAX_ROIS.
+     * @return True on success, false if the zone or region does not exist.
+     */
+    bool setZoneRoi(size_t zone_index, uint8_t roi);
+
+    /**
+     * @brief Cycles the sensor through a list of regions of interest.
+     *
+     * Each measurement uses the next region in turn, so with n regions every
+     * region is measured once per n update intervals. The next region is
+     * programmed before the current result is read, so switching costs no
+     * extra measurement. The measurement in progress when the scan changes
+     * is discarded.
+     *
+     * @param roi_list Regions to scan, copied by the monitor.
+     * @param count Number of regions, at most MAX_ROIS; 0 restores the full 16x16 field of view.
+     * @return True on success, false if count or a region is out of range.
+     */
+    bool setRoiScan(const VL53L1XRoi *roi_list, uint8_t count);
+
+    /**
+     * @brief Gets the number of regions of interest being scanned.
+     *
+     * @return The number of regions, or 0 if the full field of view is used.
+     */
+    uint8_t getRoiCount() const;
+
+    /**
+     * @brief Checks if an object is present in a specific zone.
+     *
+     * Returns the state from the last measurement evaluated by update(). It
+     * does not access the sensor and never triggers callbacks.
+     *
+     * @param zone_index The index of the zone to check.
+     * @param age_ms Optional output for the time since that measurement in
+     *               milliseconds, or UINT32_MAX if no measurement has been evaluated.
+     * @return True if an object is present, false otherwise.
+     */
+    bool isObjectInZone(size_t zone_index, uint32_t *age_ms = nullptr) const;
+
+    /**
+     * @brief Gets the presence state of 32 consecutive zones at once.
+     *
+     * @param first_zone Index of the zone reported in bit 0.
+     * @return Bit i is set if an object is present in zone first_zone + i.
+     */
+    uint32_t getOccupancyMask(size_t first_zone = 0) const;
+
+    /**
+     * @brief Copies the presence state of every zone into a bitset.
+     *
+     * Bit i of the bitset (byte i / 8, bit i % 8) is set if an object is
+     * present in zone i. Zones beyond the buffer are not reported.
+     *
+     * @param mask Buffer receiving the bitset.
+     * @param mask_bytes Size of the buffer in bytes.
+     * @return Number of bytes written.
+     */
+    size_t getOccupancyMask(uint8_t *mask, size_t mask_bytes) const;
+
+    /**
+     * @brief Gets the total number of zone slots.
+     *
+     * This equals the number of defined zones unless zones were deleted from a
+     * VL53L1XZoneMonitorT or inside a configuration transaction; deleted slots
+     * below the last zone stay reserved until reused.
+     *
+     * @return The number of zones.
+     */
+    size_t getZoneCount() const;
+
+    /**
+     * @brief Gets a view of a specific zone.
+     *
+     * Zone bounds are changed through updateZone() and callbacks through
+     * setZoneCallbacks().
+     *
+     * @param zone_index The index of the zone to retrieve.
+     * @return View of the zone, or an invalid view equal to nullptr if the index is invalid or the zone was deleted.
+     */
+    ZoneView getZone(size_t zone_index) const;
+
+    /**
+     * @brief Replaces the callbacks of an existing zone.
+     *
+     * @param zone_index The index of the zone.
+     * @param onEnter Callback function to execute when an object enters the zone.
+     * @param onExit Callback function to execute when an object exits the zone.
+     */
+    void setZoneCallbacks(size_t zone_index, ZoneEnterCallback onEnter, ZoneExitCallback onExit);
+
+#if VL53L1XZONEMONITOR_ENABLE_MOTION
+    /**
+     * @brief Sets the callback of an existing zone for predicted entries.
+     *
+     * Needs enableMotionTracking() with a lead time. The callback receives
+     * the predicted time until the object enters the zone.
+     *
+     * @param zone_index The index of the zone.
+     * @param onApproach Callback function to execute when an object is predicted to enter the zone.
+     * @return True on success, false if the index is invalid.
+     */
+    bool setZoneApproachCallback(size_t zone_index, ZoneApproachCallback onApproach);
+#endif
+
+#if VL53L1XZONEMONITOR_MAX_COUNTERS > 0
+    /**
+     * @brief Counts objects passing through an ordered path of zones, such as a doorway.
+     *
+     * A passage starts when the object enters the first or the last zone of
+     * the path, continues as it enters the following zones in order, and is
+     * counted once it has entered every zone and left them all, leaving the
+     * far end last. Turning back, or more than timeout_ms between two
+     * transitions, abandons the passage. Passages from the first zone to the
+     * last count as "in", the others as "out". The counter follows the
+     * transitions as they are detected, also with an event queue. Its
+     * callback runs inside update(), or, with an event queue, is queued as a
+     * Passage event and runs in dispatchEvents(). Combined with ROI scanning, two zones
+     * on the left and right half of the field of view count in both
+     * directions with a single sensor.
+     *
+     * Counters follow their zones when a delete moves them to lower indices.
+     * Deleting a zone of the path removes the counter, except inside a
+     * configuration transaction, where the zone may be replaced in its slot.
+     *
+     * @param zones Indices of the zones along the path.
+     * @param count Number of zones, from 2 to MAX_PASSAGE_ZONES.
+     * @param timeout_ms Longest time between two transitions of one passage in milliseconds.
+     * @param onPassage Optional callback for every counted passage.
+     * @return The index of the counter, or INVALID_COUNTER if all counters are in use or a zone is invalid.
+     */
+    uint8_t addPassageCounter(const size_t *zones, uint8_t count, uint32_t timeout_ms, PassageCallback onPassage = nullptr);
+
+    /**
+     * @brief Removes a passage counter.
+     *
+     * @param counter The index of the counter.
+     */
+    void removePassageCounter(uint8_t counter);
+
+    /**
+     * @brief Gets the number of passages counted in the "in" direction, from the first zone to the last.
+     *
+     * @param counter The index of the counter.
+     * @return The number of passages, or 0 if the counter is invalid.
+     */
+    uint32_t getPassagesIn(uint8_t counter) const;
+
+    /**
+     * @brief Gets the number of passages counted in the "out" direction, from the last zone to the first.
+     *
+     * @param counter The index of the counter.
+     * @return The number of passages, or 0 if the counter is invalid.
+     */
+    uint32_t getPassagesOut(uint8_t counter) const;
+
+    /**
+     * @brief Clears the counts of a passage counter and abandons a passage in progress.
+     *
+     * @param counter The index of the counter.
+     */
+    void resetPassageCounter(uint8_t counter);
+#endif
+
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+    /**
+     * @brief Adds a zone group reporting the aggregate occupancy of its zones.
+     *
+     * Overlapping zones see the same object, so one movement can fire
+     * several enter and exit callbacks. A group turns them into at most one
+     * change per update(): GroupOccupied when the first member enters,
+     * GroupEmpty when the last one exits, and NearestChanged when, while
+     * occupied, a different member becomes the occupied zone with the lowest
+     * minimum distance. The group is kept up to date from the transitions at
+     * constant cost per member. Its callback runs inside update(), or, with an
+     * event queue, is queued as a GroupChange event and runs in
+     * dispatchEvents(), so it never runs on the background task.
+     *
+     * Deleting a zone removes it from its groups without reporting a change.
+     *
+     * @param zones Indices of the member zones.
+     * @param count Number of zones.
+     * @param onChange Optional callback for every change of the group.
+     * @return The index of the group, or INVALID_GROUP if all groups are in use or a zone is invalid.
+     */
+    uint8_t addZoneGroup(const size_t *zones, size_t count, ZoneGroupCallback onChange = nullptr);
+
+    /**
+     * @brief Adds a zone to a group.
+     *
+     * The group's state is recounted; a change is reported by the next update().
+     *
+     * @param group The index of the group.
+     * @param zone_index The index of the zone.
+     * @return True on success, false if the group or the zone is invalid.
+     */
+    bool addZoneToGroup(uint8_t group, size_t zone_index);
+
+    /**
+     * @brief Removes a zone from a group.
+     *
+     * The group's state is recounted; a change is reported by the next update().
+     *
+     * @param group The index of the group.
+     * @param zone_index The index of the zone.
+     * @return True on success, false if the group or the zone is invalid.
+     */
+    bool removeZoneFromGroup(uint8_t group, size_t zone_index);
+
+    /**
+     * @brief Removes a zone group; its zones are kept.
+     *
+     * @param group The index of the group.
+     */
+    void removeZoneGroup(uint8_t group);
+
+    /**
+     * @brief Checks whether any zone of a group has an object present.
+     *
+     * @param group The index of the group.
+     * @return True if the group is occupied, false if it is empty or invalid.
+     */
+    bool isZoneGroupOccupied(uint8_t group) const;
+
+    /**
+     * @brief Gets the occupied zone of a group with the lowest minimum distance.
+     *
+     * Ties go to the lower zone index.
+     *
+     * @param group The index of the group.
+     * @return The index of the zone, or INVALID_ZONE if the group is empty or invalid.
+     */
+    size_t getNearestOccupiedZone(uint8_t group) const;
+#endif
+
+    /**
+     * @brief Deletes a specific zone.
+     *
+     * VL53L1XZoneMonitor moves all later zones down by one index, except
+     * inside a configuration transaction or while an event queue is attached,
+     * so that queued events keep their zone. VL53L1XZoneMonitorT, and
+     * VL53L1XZoneMonitor in those cases, leave every other index unchanged
+     * and reuse the deleted slot for the next zone that is added.
+     *
+     * @param zone_index The index of the zone to delete.
+     */
+    void deleteZone(size_t zone_index);
+
+    /**
+     * @brief Gets the most recent distance measured by the sensor.
+     *
+     * Returns the measurement last read by update() and evaluated by the zones,
+     * without accessing the sensor.
+     *
+     * @return The measured distance in millimeters, or 0 if no measurement has been read yet.
+     */
+    uint16_t getDistance() const;
+
+    /**
+     * @brief Gets the most recent measurement with its status, timestamp and sequence number.
+     *
+     * Like getDistance(), this does not access the sensor. Comparing the
+     * sequence number with an earlier one tells whether a new measurement
+     * has arrived in between.
+     *
+     * @return The last sample read by update().
+     */
+    const VL53L1XSample &getLastSample() const;
+
+    /**
+     * @brief Sets the certainty factor for measurements.
+     *
+     * The certainty factor defines the number of consecutive measurements required
+     * to confirm an object's presence or absence.
+     *
+     * @param certainty The number of consecutive measurements required.
+     */
+    void setCertaintyFactor(size_t certainty);
+
+    /**
+     * @brief Gets the current certainty factor for measurements.
+     *
+     * @return The number of consecutive measurements required.
+     */
+    size_t getCertaintyFactor() const;
+
+    /**
+     * @brief Configures which measurements are evaluated by the zones.
+     *
+     * Rejected measurements are still stored as the last sample, with
+     * VL53L1XSample::valid cleared, but leave all zone counters untouched.
+     * Filtering sigma, signal and wrap-around failures here means the
+     * certainty factor only has to cover real noise, which shortens the
+     * detection latency. By default every measurement is accepted.
+     *
+     * @param status_mask Bit n accepts VL53L1X::RangeStatus n, e.g. VALID_RANGE_STATUSES
+     *        or ALL_RANGE_STATUSES. Statuses above 31 only pass ALL_RANGE_STATUSES.
+     * @param min_signal_mcps Minimum peak signal rate in MCPS, or 0 for no minimum.
+     * @param max_ambient_mcps Maximum ambient rate in MCPS, or 0 for no maximum.
+     *        The rates are not checked for measurements from a sample source.
+     */
+    void setSampleFilter(uint32_t status_mask, float min_signal_mcps = 0, float max_ambient_mcps = 0);
+
+    /**
+     * @brief Gets the range status mask of the sample filter.
+     *
+     * @return Bit n set if VL53L1X::RangeStatus n is accepted.
+     */
+    uint32_t getSampleFilter() const;
+
+    /**
+     * @brief Rejects measurements with a low confidence.
+     *
+     * The VL53L1X reports a single target per measurement, so a weak return
+     * from a second object behind a nearer one is never seen; what the
+     * ranging data does tell is how trustworthy the reported target is. The
+     * confidence of each sample is 255 * signal / (signal + ambient) for
+     * RangeValid, half of that for RangeValidMinRangeClipped and
+     * RangeValidNoWrapCheckFail, and 0 for all other statuses. Measurements
+     * from a sample source carry no rates and get 255 if they are RangeValid.
+     * The value is reported in getLastSample().confidence in any case.
+     *
+     * @param confidence Minimum confidence from 0 to 255; 0 accepts every measurement.
+     */
+    void setMinConfidence(uint8_t confidence);
+
+    /**
+     * @brief Gets the minimum confidence of the sample filter.
+     *
+     * @return The minimum confidence; 0 if measurements are not rejected by confidence.
+     */
+    uint8_t getMinConfidence() const;
+
+    /**
+     * @brief Splits each sensor read into short I²C transfers spread over update() calls.
+     *
+     * The driver's read() transfers the whole result block, writes the SPAD
+     * target and clears the interrupt in one blocking call. In asynchronous
+     * mode each update() performs at most one of these transfers, a few
+     * bytes long, and returns; the measurement is evaluated by the call that
+     * completes it. This bounds the time a single update() can stall the
+     * loop, at the cost of a few calls of latency. The first read after
+     * ranging starts always uses the driver, which calibrates on it.
+     *
+     * @param enable True to read in steps, false to read in one call.
+     */
+    void setAsyncRead(bool enable);
+
+    /**
+     * @brief Checks whether asynchronous reads are enabled.
+     *
+     * @return True if reads are split over several update() calls.
+     */
+    bool isAsyncRead() const;
+
+    /**
+     * @brief Shares the I²C bus with other drivers through a lock.
+     *
+     * Every sensor access takes the lock and gives it back before zones are
+     * evaluated and callbacks run. In update() the lock is held for one
+     * read, or with setAsyncRead() for one short transfer or the bus budget,
+     * which bounds how long other devices wait. If the lock is not free
+     * within wait_ms, update() skips the sensor and returns false; the
+     * measurement is read by a later call. Configuration calls wait until
+     * the bus is free.
+     *
+     * @param lock Lock shared with the other drivers, or nullptr to use the bus without locking.
+     * @param wait_ms Longest wait for the lock in update() in milliseconds; 0 only tries.
+     */
+    void setBusLock(VL53L1XBusLock *lock, uint32_t wait_ms = 0);
+
+    /**
+     * @brief Gets the bus lock.
+     *
+     * @return The lock, or nullptr if the bus is used without locking.
+     */
+    VL53L1XBusLock *getBusLock() const;
+
+    /**
+     * @brief Sets how much bus time an update() may spend on an asynchronous read.
+     *
+     * With setAsyncRead(), update() performs read steps under one lock hold
+     * until the measurement is complete or the budget is used up, so the
+     * monitor gets its measurement within one frame of the loop while other
+     * devices wait at most about the budget plus one step.
+     *
+     * @param budget_us Bus time per update() in microseconds; 0 for one step per call.
+     */
+    void setBusBudget(uint32_t budget_us);
+
+    /**
+     * @brief Gets the bus time an update() may spend on an asynchronous read.
+     *
+     * @return The budget in microseconds; 0 for one step per call.
+     */
+    uint32_t getBusBudget() const;
+
+#if VL53L1XZONEMONITOR_ENABLE_PREFILTER
+    /**
+     * @brief Selects a prefilter smoothing distances before zone evaluation.
+     *
+     * One filtered distance per measurement is shared by all zones, so a
+     * short median rejects outliers with less delay than a high certainty
+     * factor. Only measurements passing the sample filter are filtered;
+     * VL53L1XSample::raw_distance keeps the unfiltered value.
+     *
+     * @param mode VL53L1XDistanceFilter::None, Median or Ema.
+     * @param parameter Median window of 3, 5 or 7, or EMA weight exponent from 1 to 8.
+     * @return True on success, false if the parameter is out of range.
+     */
+    bool setPrefilter(VL53L1XDistanceFilter::Mode mode, uint8_t parameter = 0);
+
+    /**
+     * @brief Gets the prefilter.
+     *
+     * @return The prefilter and its configuration.
+     */
+    const VL53L1XDistanceFilter &getPrefilter() const;
+#endif
+
+    /**
+     * @brief Updates the sensor measurements and evaluates all zones.
+     *
+     * Does nothing while the background task started by startTask() is running.
+     *
+     * @return True if a new measurement was read, false otherwise. With
+     *         setAsyncRead(), false is also returned while a read is in progress.
+     *         Always false inside a configuration transaction.
+     */
+    bool update();
+
+    /**
+     * @brief Replaces the sensor and clock with a sample source.
+     *
+     * While a source is attached, update() takes each measurement and its
+     * timestamp from the source instead of polling the sensor, and the
+     * update interval is left to the source. Used to replay recorded traces
+     * and to benchmark zone evaluation on the host; see VL53L1XReplaySource.
+     *
+     * @param source The source, or nullptr to read the sensor again.
+     */
+    void setSampleSource(VL53L1XSampleSource *source);
+
+    /**
+     * @brief Gets the attached sample source.
+     *
+     * @return The source, or nullptr if the sensor is read.
+     */
+    VL53L1XSampleSource *getSampleSource() const;
+
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+    /**
+     * @brief Gets the hot-path statistics collected since the last reset.
+     *
+     * @return The statistics.
+     */
+    const VL53L1XMonitorStats &getStats() const;
+
+    /**
+     * @brief Gets the callback timing of one zone since it was added or the last reset.
+     *
+     * The statistics follow the zone when deleteZone() moves it to a lower index.
+     *
+     * @param zone_index The index of the zone.
+     * @return The statistics, or empty ones if the zone does not exist.
+     */
+    VL53L1XTimingStats getZoneCallbackStats(size_t zone_index) const;
+
+    /**
+     * @brief Clears all statistics, including those of each zone.
+     */
+    void resetStats();
+#endif
+
+    /**
+     * @brief Selects deferred dispatch of zone transitions.
+     *
+     * With a queue, zone evaluation only records each transition with its zone,
+     * edge, distance and timestamp, and no callback runs inside update(). The
+     * application later runs the callbacks with dispatchEvents() or takes the
+     * raw events with pollEvents(), e.g. to publish many in one packet.
+     * Passing nullptr restores inline callbacks; events still in the previous
+     * queue stay there.
+     *
+     * @param queue Queue receiving zone transitions, or nullptr.
+     */
+    void setEventQueue(ZoneEventQueue *queue);
+
+    /**
+     * @brief Gets the queue used for deferred dispatch.
+     *
+     * @return The queue, or nullptr if callbacks are called inline.
+     */
+    ZoneEventQueue *getEventQueue() const;
+
+#if VL53L1XZONEMONITOR_ENABLE_SAMPLE_LOG
+    /**
+     * @brief Records every raw measurement in a sample log.
+     *
+     * Each measurement read by update() is appended before filtering,
+     * including rejected ones, so the application can log data without
+     * reading the sensor itself. Drain the log with peek() and consume() or
+     * stream it with writeFrame(). With the ESP32 task running, the task is
+     * the producer and the loop may consume concurrently.
+     *
+     * @param log Log receiving the measurements, or nullptr to stop logging.
+     */
+    void setSampleLog(VL53L1XSampleLog *log);
+
+    /**
+     * @brief Gets the log receiving raw measurements.
+     *
+     * @return The log, or nullptr if measurements are not logged.
+     */
+    VL53L1XSampleLog *getSampleLog() const;
+#endif
+
+    /**
+     * @brief Removes queued zone transitions without calling their callbacks.
+     *
+     * Like dispatchEvents(), it never takes the state lock and skips the
+     * events of deleted zones.
+     *
+     * @param events Buffer receiving the events, oldest first.
+     * @param max_events Size of the buffer.
+     * @return The number of events written to the buffer.
+     */
+    size_t pollEvents(ZoneEvent *events, size_t max_events);
+
+    /**
+     * @brief Calls the callbacks of queued zone transitions.
+     *
+     * Events are dispatched in the order they occurred. Events of zones that
+     * have since been deleted are discarded, even if a new zone has taken the
+     * slot. Events are popped without the state lock, so this never waits for
+     * a measurement in progress; call it from the context that adds and
+     * deletes zones.
+     *
+     * @param max_events Maximum number of events to dispatch in this call.
+     * @return The number of events removed from the queue.
+     */
+    size_t dispatchEvents(size_t max_events = SIZE_MAX);
+
+#if defined(ESP32)
+    /**
+     * @brief Starts reading the sensor in a pinned background FreeRTOS task.
+     *
+     * The task waits for the GPIO1 interrupt if init() was given an interrupt
+     * pin, or otherwise sleeps for the update interval between polls. Zone
+     * transitions are pushed into the queue instead of calling the callbacks
+     * inline, and the application calls dispatchEvents() to run them on its
+     * own task. Configuration methods can still be called; they are serialized
+     * with the task by a mutex.
+     *
+     * @param queue Queue receiving zone transitions, as with setEventQueue(); must outlive the task.
+     * @param core CPU core to pin the task to.
+     * @param priority FreeRTOS priority of the task.
+     * @param stack_size Stack size of the task in bytes.
+     * @return True if the task was started, false if it is already running or could not be created.
+     */
+    bool startTask(ZoneEventQueue &queue, BaseType_t core = 0, UBaseType_t priority = 2, uint32_t stack_size = 4096);
+
+    /**
+     * @brief Stops the background task.
+     *
+     * The event queue stays selected, so transitions from later update() calls
+     * are still queued until setEventQueue(nullptr) is called.
+     */
+    void stopTask();
+
+    /**
+     * @brief Checks whether the background task is running.
+     *
+     * @return True if the task is running, false otherwise.
+     */
+    bool isTaskRunning() const;
+#endif
+};
+
+/**
+ * @brief Zone monitor whose zone storage grows as zones are added.
+ */
+class VL53L1XZoneMonitor : public VL53L1XZoneMonitorBase {
+private:
+    std::vector<uint16_t> min_storage;           /**< Backing storage for zone_min. */
+    std::vector<uint16_t> max_storage;           /**< Backing storage for zone_max. */
+    std::vector<uint8_t> in_count_storage;       /**< Backing storage for zone_in_count. */
+    std::vector<uint8_t> out_count_storage;      /**< Backing storage for zone_out_count. */
+    std::vector<uint16_t> hysteresis_storage;    /**< Backing storage for zone_hysteresis. */
+    std::vector<uint8_t> certainty_storage;      /**< Backing storage for zone_certainty. */
+    std::vector<uint8_t> roi_storage;            /**< Backing storage for zone_roi. */
+    std::vector<uint8_t> present_storage;        /**< Backing storage for zone_present. */
+    std::vector<uint8_t> approaching_storage;    /**< Backing storage for zone_approaching. */
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+    std::vector<uint8_t> group_storage;          /**< Backing storage for zone_groups. */
+#endif
+    std::vector<uint8_t> generation_storage;     /**< Backing storage for zone_generation. */
+    std::vector<uint8_t> used_storage;           /**< Backing storage for zone_used. */
+    std::vector<ZoneCallbacks> callback_storage; /**< Backing storage for zone_callbacks. */
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+    std::vector<VL53L1XTimingStats> callback_stats_storage; /**< Backing storage for zone_callback_us. */
+#endif
+    std::vector<uint16_t> index_bound_storage;   /**< Backing storage for index_bounds. */
+    std::vector<uint16_t> index_offset_storage;  /**< Backing storage for index_offsets. */
+    std::vector<uint16_t> index_member_storage;  /**< Backing storage for index_members. */
+    std::vector<uint16_t> active_storage;        /**< Backing storage for active_zones. */
+    std::vector<uint16_t> candidate_storage;     /**< Backing storage for candidate_zones. */
+    size_t free_slots;                           /**< Number of slots freed inside configuration transactions. */
+
+    /**
+     * @brief Points the base class at the current zone storage.
+     */
+    void syncZoneBuffers();
+
+    /**
+     * @brief Removes a bit from a bitset, moving all later bits down by one.
+     *
+     * @param bits The bitset.
+     * @param index The bit to remove.
+     * @param count Number of bits in use.
+     */
+    static void eraseBit(uint8_t *bits, size_t index, size_t count);
+
+protected:
+    size_t allocateZoneSlot() override;
+    bool releaseZoneSlot(size_t zone_index, bool keep_indices) override;
+    size_t getZoneCapacity() const override;
+    bool reserveZoneIndex(size_t bound_count, size_t member_count) override;
+
+public:
+    /**
+     * @brief Constructs a VL53L1XZoneMonitor object.
+     *
+     * @param wire Optional pointer to a TwoWire object for custom I²C bus.
+     * @param interval_ms Interval for continuous measurements in milliseconds.
+     * @param certainty Number of consecutive measurements required for stability.
+     */
+    VL53L1XZoneMonitor(TwoWire *wire = nullptr, uint32_t interval_ms = 50, size_t certainty = 1);
+};
+
+/**
+ * @brief Zone monitor with fixed-capacity zone storage.
+ *
+ * All zone and index storage is part of the object, so memory use is known at
+ * link time and the heap is never used for zones. Deleting a zone is O(1) and
+ * never changes the index of any other zone; the slot is reused by the next
+ * addZone() call.
+ *
+ * @tparam MaxZones Maximum number of zones.
+ * @tparam MaxIndexEntries Capacity of the interval index. Each zone needs one
+ *         entry plus one for every boundary of another zone inside it. If the
+ *         index does not fit, zones are evaluated with a linear scan instead.
+ *         At most 65535; the default is 4 * MaxZones, capped at that.
+ */
+template <size_t MaxZones, size_t MaxIndexEntries = (4 * MaxZones < UINT16_MAX ? 4 * MaxZones : UINT16_MAX)>
+class VL53L1XZoneMonitorT : public VL53L1XZoneMonitorBase {
+    static_assert(MaxZones > 0 && MaxZones <= UINT16_MAX, "VL53L1XZoneMonitorT: MaxZones must be between 1 and 65535");
+    static_assert(MaxIndexEntries <= UINT16_MAX, "VL53L1XZoneMonitorT: MaxIndexEntries must be at most 65535");
+
+private:
+    static const size_t BITSET_BYTES = (MaxZones + 7) / 8;
+
+    uint16_t min_storage[MaxZones];                /**< Backing storage for zone_min. */
+    uint16_t max_storage[MaxZones];                /**< Backing storage for zone_max. */
+    uint8_t in_count_storage[MaxZones];            /**< Backing storage for zone_in_count. */
+    uint8_t out_count_storage[MaxZones];           /**< Backing storage for zone_out_count. */
+    uint16_t hysteresis_storage[MaxZones];         /**< Backing storage for zone_hysteresis. */
+    uint8_t certainty_storage[MaxZones];           /**< Backing storage for zone_certainty. */
+    uint8_t roi_storage[MaxZones];                 /**< Backing storage for zone_roi. */
+    uint8_t present_storage[BITSET_BYTES];         /**< Backing storage for zone_present. */
+    uint8_t approaching_storage[BITSET_BYTES];     /**< Backing storage for zone_approaching. */
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+    uint8_t group_storage[MaxZones];               /**< Backing storage for zone_groups. */
+#endif
+    uint8_t generation_storage[MaxZones];          /**< Backing storage for zone_generation. */
+    uint8_t used_storage[BITSET_BYTES];            /**< Backing storage for zone_used. */
+    ZoneCallbacks callback_storage[MaxZones];      /**< Backing storage for zone_callbacks. */
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+    VL53L1XTimingStats callback_stats_storage[MaxZones]; /**< Backing storage for zone_callback_us. */
+#endif
+    uint16_t index_bound_storage[2 * MaxZones];    /**< Backing storage for index_bounds. */
+    uint16_t index_offset_storage[2 * MaxZones + 1]; /**< Backing storage for index_offsets. */
+    uint16_t index_member_storage[MaxIndexEntries]; /**< Backing storage for index_members. */
+    uint16_t active_storage[MaxZones];             /**< Backing storage for active_zones. */
+    uint16_t candidate_storage[MaxZones];          /**< Backing storage for candidate_zones. */
+    size_t free_slots;                             /**< Number of deleted slots below zone_slots. */
+
+protected:
+    size_t allocateZoneSlot() override
+    {
+        if (free_slots > 0)
+        {
+            for (size_t i = 0; i < zone_slots; i++)
+            {
+                if (!testBit(used_storage, i))
+                {
+                    setBit(used_storage, i);
+                    free_slots--;
+                    return i;
+                }
+            }
+        }
+        if (zone_slots < MaxZones)
+        {
+            setBit(used_storage, zone_slots);
+            return zone_slots++;
+        }
+        return INVALID_ZONE;
+    }
+
+    bool releaseZoneSlot(size_t zone_index, bool keep_indices) override
+    {
+        (void)keep_indices; // Indices never move.
+        clearBit(used_storage, zone_index);
+        free_slots++;
+        while (zone_slots > 0 && !testBit(used_storage, zone_slots - 1))
+        {
+            zone_slots--;
+            free_slots--;
+        }
+        return false;
+    }
+
+    size_t getZoneCapacity() const override
+    {
+        return MaxZones;
+    }
+
+    bool reserveZoneIndex(size_t bound_count, size_t member_count) override
+    {
+        return bound_count <= 2 * MaxZones && member_count <= MaxIndexEntries;
+    }
+
+public:
+    /**
+     * @brief Constructs a VL53L1XZoneMonitorT object.
+     *
+     * @param wire Optional pointer to a TwoWire object for custom I²C bus.
+     * @param interval_ms Interval for continuous measurements in milliseconds.
+     * @param certainty Number of consecutive measurements required for stability.
+     */
+    VL53L1XZoneMonitorT(TwoWire *wire = nullptr, uint32_t interval_ms = 50, size_t certainty = 1)
+        : VL53L1XZoneMonitorBase(wire, interval_ms, certainty), present_storage(), approaching_storage(), used_storage(), free_slots(0)
+    {
+        zone_min = min_storage;
+        zone_max = max_storage;
+        zone_in_count = in_count_storage;
+        zone_out_count = out_count_storage;
+        zone_hysteresis = hysteresis_storage;
+        zone_certainty = certainty_storage;
+        zone_roi = roi_storage;
+        zone_present = present_storage;
+        zone_approaching = approaching_storage;
+#if VL53L1XZONEMONITOR_MAX_GROUPS > 0
+        zone_groups = group_storage;
+#endif
+        zone_generation = generation_storage;
+        zone_used = used_storage;
+        zone_callbacks = callback_storage;
+#if VL53L1XZONEMONITOR_ENABLE_STATS
+        zone_callback_us = callback_stats_storage;
+#endif
+        index_bounds = index_bound_storage;
+        index_offsets = index_offset_storage;
+        index_members = index_member_storage;
+        active_zones = active_storage;
+        candidate_zones = candidate_storage;
+    }
 };
 
 #endif
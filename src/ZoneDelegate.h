@@ -0,0 +1,89 @@
+#ifndef ZONEDELEGATE_H
+#define ZONEDELEGATE_H
+
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+
+template <typename Signature>
+class ZoneDelegate;
+
+/**
+ * @brief Fixed-size, non-allocating callback used for zone events.
+ *
+ * A ZoneDelegate stores a plain function pointer, a function pointer bound to
+ * a context pointer, or a lambda whose captures fit into STORAGE_SIZE bytes,
+ * directly inside the object. It never touches the heap and is copied like a
+ * plain struct, so zones can be created and destroyed at run time without
+ * fragmenting memory. Callables that are too large or not trivially copyable
+ * are rejected at compile time; capture a pointer to a larger object instead.
+ */
+template <typename R, typename... Args>
+class ZoneDelegate<R(Args...)> {
+public:
+    static const size_t STORAGE_SIZE = 2 * sizeof(void *); /**< Bytes available for the callable's captures. */
+
+    /**
+     * @brief Constructs an empty delegate.
+     */
+    ZoneDelegate() : invoker(nullptr) {}
+
+    /**
+     * @brief Constructs an empty delegate.
+     */
+    ZoneDelegate(std::nullptr_t) : invoker(nullptr) {}
+
+    /**
+     * @brief Constructs a delegate from a function pointer or a small lambda.
+     *
+     * @param callable The function or lambda to call.
+     */
+    template <typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, ZoneDelegate>::value>::type>
+    ZoneDelegate(F callable)
+    {
+        static_assert(sizeof(F) <= STORAGE_SIZE, "ZoneDelegate: callable is too large; capture a pointer or use a context pointer");
+        static_assert(alignof(F) <= alignof(void *), "ZoneDelegate: callable is over-aligned");
+        static_assert(std::is_trivially_copyable<F>::value, "ZoneDelegate: callable must be trivially copyable");
+        new (storage) F(callable);
+        invoker = &invoke<F>;
+    }
+
+    /**
+     * @brief Constructs a delegate that calls a function with a context pointer.
+     *
+     * @param function The function to call; receives the context as its first argument.
+     * @param context Pointer passed through to the function on every call.
+     */
+    ZoneDelegate(R (*function)(void *, Args...), void *context)
+        : ZoneDelegate(function ? ZoneDelegate(Bound{function, context}) : ZoneDelegate()) {}
+
+    /**
+     * @brief Checks whether the delegate holds a callable.
+     *
+     * @return True if a callable is stored, false if the delegate is empty.
+     */
+    explicit operator bool() const { return invoker != nullptr; }
+
+    /**
+     * @brief Calls the stored callable. The delegate must not be empty.
+     */
+    R operator()(Args... args) const { return invoker(const_cast<unsigned char *>(storage), args...); }
+
+private:
+    struct Bound {
+        R (*function)(void *, Args...);
+        void *context;
+        R operator()(Args... args) const { return function(context, args...); }
+    };
+
+    template <typename F>
+    static R invoke(void *callable, Args... args)
+    {
+        return (*static_cast<F *>(callable))(args...);
+    }
+
+    R (*invoker)(void *, Args...);                  /**< Type-specific trampoline, or nullptr if empty. */
+    alignas(void *) unsigned char storage[STORAGE_SIZE]; /**< In-place copy of the callable. */
+};
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef ZONEEVENTQUEUE_H
+#define ZONEEVENTQUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+/**
+ * @brief A zone transition, zone group change or counted passage recorded for later dispatch.
+ */
+struct ZoneEvent {
+    enum Type : uint8_t {
+        Enter,      /**< An object entered the zone. */
+        Exit,       /**< An object left the zone. */
+        Approach,   /**< An object is predicted to enter the zone within the lead time. */
+        GroupChange, /**< A zone group changed; zone is its nearest occupied zone, or UINT16_MAX once it is empty. */
+        Passage      /**< A passage counter counted a passage; zone is the zone whose exit completed it. */
+    };
+
+    uint16_t zone;      /**< Index of the zone at the time of the transition. */
+    Type type;          /**< Kind of transition. */
+    uint8_t generation; /**< Generation of the zone slot, so that events of a deleted zone never reach a zone that reuses its slot. */
+    uint16_t distance;  /**< Distance of the measurement that caused the transition in millimeters. */
+    union {
+        uint16_t eta_ms; /**< Predicted time until entry in milliseconds for Approach events, 0 for Enter and Exit. */
+        struct {
+            uint8_t index; /**< Index of the zone group or passage counter. */
+            int8_t value;  /**< The VL53L1XZoneMonitorBase::GroupChange, or the passage direction, +1 in or -1 out. */
+        } source;          /**< Origin of GroupChange and Passage events. */
+    };
+    uint32_t timestamp; /**< millis() at the time the measurement was read. */
+};
+
+/**
+ * @brief Lock-free single-producer, single-consumer ring buffer of zone events.
+ *
+ * One task or context may push while another pops without any locking; the
+ * indices are published with release/acquire ordering. The storage is
+ * supplied by the caller or by ZoneEventQueueT, so the queue never
+ * allocates. One slot is kept free to tell a full queue from an empty one.
+ * Events pushed while the queue is full are dropped and counted.
+ */
+class ZoneEventQueue {
+private:
+    ZoneEvent *buffer;              /**< Event storage. */
+    uint16_t capacity;              /**< Number of slots in buffer. */
+    std::atomic<uint16_t> head;     /**< Next slot to write; owned by the producer. */
+    std::atomic<uint16_t> tail;     /**< Next slot to read; owned by the consumer. */
+    std::atomic<uint32_t> dropped;  /**< Events lost because the queue was full. */
+
+public:
+    /**
+     * @brief Constructs a queue on caller-supplied storage.
+     *
+     * @param storage Array of at least slots events.
+     * @param slots Number of events in storage, between 2 and 65535; holds slots - 1 events.
+     */
+    ZoneEventQueue(ZoneEvent *storage, size_t slots)
+        : buffer(storage), capacity(slots > UINT16_MAX ? UINT16_MAX : slots), head(0), tail(0), dropped(0) {}
+
+    ZoneEventQueue(const ZoneEventQueue &) = delete;
+    ZoneEventQueue &operator=(const ZoneEventQueue &) = delete;
+
+    /**
+     * @brief Appends an event. Must only be called by the producer.
+     *
+     * @param event The event to append.
+     * @return True if the event was queued, false if the queue was full.
+     */
+    bool push(const ZoneEvent &event)
+    {
+        uint16_t h = head.load(std::memory_order_relaxed);
+        uint16_t next = (h + 1 == capacity) ? 0 : h + 1;
+        if (next == tail.load(std::memory_order_acquire))
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        buffer[h] = event;
+        head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest event. Must only be called by the consumer.
+     *
+     * @param event Receives the event.
+     * @return True if an event was removed, false if the queue was empty.
+     */
+    bool pop(ZoneEvent &event)
+    {
+        uint16_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+            return false;
+        event = buffer[t];
+        tail.store((t + 1 == capacity) ? 0 : t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Gets the number of queued events.
+     *
+     * @return The number of events waiting to be popped.
+     */
+    size_t size() const
+    {
+        uint16_t h = head.load(std::memory_order_acquire);
+        uint16_t t = tail.load(std::memory_order_acquire);
+        return h >= t ? h - t : capacity - t + h;
+    }
+
+    /**
+     * @brief Gets the number of events dropped because the queue was full.
+     *
+     * @return The number of dropped events.
+     */
+    uint32_t getDroppedCount() const
+    {
+        return dropped.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief ZoneEventQueue with built-in storage for Capacity events.
+ *
+ * @tparam Capacity Maximum number of queued events.
+ */
+template <size_t Capacity>
+class ZoneEventQueueT : public ZoneEventQueue {
+    static_assert(Capacity > 0 && Capacity < UINT16_MAX, "ZoneEventQueueT: Capacity must be between 1 and 65534");
+
+private:
+    ZoneEvent storage[Capacity + 1]; /**< Event storage, including the slot kept free. */
+
+public:
+    ZoneEventQueueT() : ZoneEventQueue(storage, Capacity + 1) {}
+};
+
+#endif